@@ -0,0 +1,357 @@
+//---------------------------------------------------------
+// file:    allocator.c
+// author:  Jordan Hoffmann
+// brief:   Library for pluggable allocators used by the containers, with
+//          bump arena and fixed size pool implementations
+//---------------------------------------------------------
+
+#include "allocator.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+#define ALLOC_ROUND(size) (((size) + ALLOC_ALIGN - 1) & ~(size_t)(ALLOC_ALIGN - 1))
+
+// pool blocks double in size until they reach this many bytes
+#define POOL_MAX_BLOCK (16 << 20)
+
+// arena blocks double in size until they reach this many bytes
+#define ARENA_MAX_BLOCK ((size_t)64 << 20)
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static void *_default_alloc(void *ctx, size_t size);
+static void *_default_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size);
+static void _default_free(void *ctx, void *ptr);
+static _ArenaBlock *_block_create(Allocator *parent, size_t capacity);
+static void *_arena_alloc(void *ctx, size_t size);
+static void *_arena_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size);
+static void _arena_free(void *ctx, void *ptr);
+static void *_pool_alloc(void *ctx, size_t size);
+static void *_pool_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size);
+static void _pool_free(void *ctx, void *ptr);
+static _ArenaBlock *_pool_owner(Pool *pool, void *ptr);
+
+//---------------------------------------------------------
+// Private Variables:
+//---------------------------------------------------------
+
+static Allocator default_allocator = { _default_alloc, _default_realloc, _default_free, NULL, ALLOC_DEFAULT };
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+Allocator *alloc_default(void) {
+	return &default_allocator;
+}
+
+void *alloc_malloc(Allocator *allocator, size_t size) {
+	if (!allocator) {
+		return malloc(size);
+	}
+	return (*allocator->alloc)(allocator->ctx, size);
+}
+
+void *alloc_realloc(Allocator *allocator, void *ptr, size_t old_size, size_t new_size) {
+	if (!allocator) {
+		return realloc(ptr, new_size);
+	}
+	return (*allocator->realloc)(allocator->ctx, ptr, old_size, new_size);
+}
+
+void alloc_free(Allocator *allocator, void *ptr) {
+	if (!allocator) {
+		free(ptr);
+	}
+	else if (ptr) {
+		(*allocator->free)(allocator->ctx, ptr);
+	}
+}
+
+bool alloc_is_region(Allocator *allocator) {
+	return allocator && (allocator->flags & ALLOC_REGION);
+}
+
+Arena *arena_create(size_t block_size, Allocator *parent) {
+	Arena *arena = alloc_malloc(parent, sizeof(Arena));
+	if (!arena) {
+		printf("failed to allocate arena");
+		return NULL;
+	}
+	arena->allocator.alloc = _arena_alloc;
+	arena->allocator.realloc = _arena_realloc;
+	arena->allocator.free = _arena_free;
+	arena->allocator.ctx = arena;
+	arena->allocator.flags = ALLOC_REGION;
+	arena->parent = parent;
+	arena->blocks = NULL;
+	arena->block_size = ALLOC_ROUND(block_size ? block_size : 1);
+	arena->last = NULL;
+	arena->bytes_reserved = 0;
+	return arena;
+}
+
+void arena_free(Arena *arena) {
+	if (!arena) {
+		return;
+	}
+	while (arena->blocks) {
+		_ArenaBlock *next = arena->blocks->next;
+		alloc_free(arena->parent, arena->blocks);
+		arena->blocks = next;
+	}
+	alloc_free(arena->parent, arena);
+}
+
+void arena_reset(Arena *arena) {
+	// one regular block is kept, so an arena reused per request doesn't allocate again.
+	// blocks bigger than block_size were made for one oversized allocation and aren't kept
+	_ArenaBlock *keep = NULL;
+	while (arena->blocks) {
+		_ArenaBlock *next = arena->blocks->next;
+		_ArenaBlock *drop = arena->blocks;
+		if (drop->capacity <= arena->block_size && (!keep || drop->capacity > keep->capacity)) {
+			drop = keep;
+			keep = arena->blocks;
+		}
+		if (drop) {
+			alloc_free(arena->parent, drop);
+		}
+		arena->blocks = next;
+	}
+	arena->blocks = keep;
+	arena->last = NULL;
+	arena->bytes_reserved = 0;
+	if (keep) {
+		keep->next = NULL;
+		keep->used = 0;
+		arena->bytes_reserved = sizeof(_ArenaBlock) + keep->capacity;
+	}
+}
+
+Allocator *arena_allocator(Arena *arena) {
+	return &arena->allocator;
+}
+
+Pool *pool_create(size_t item_size, int items_per_block, Allocator *parent) {
+	Pool *pool = alloc_malloc(parent, sizeof(Pool));
+	if (!pool) {
+		printf("failed to allocate pool");
+		return NULL;
+	}
+	pool->allocator.alloc = _pool_alloc;
+	pool->allocator.realloc = _pool_realloc;
+	pool->allocator.free = _pool_free;
+	pool->allocator.ctx = pool;
+	pool->allocator.flags = ALLOC_DEFAULT;
+	pool->parent = parent;
+	// every free slot holds the next one, so it has to fit a pointer
+	pool->item_size = ALLOC_ROUND(item_size < sizeof(void *) ? sizeof(void *) : item_size);
+	pool->items_per_block = items_per_block > 0 ? items_per_block : 1;
+	pool->free_list = NULL;
+	pool->blocks = NULL;
+	pool->bytes_reserved = 0;
+	return pool;
+}
+
+void pool_free(Pool *pool) {
+	if (!pool) {
+		return;
+	}
+	while (pool->blocks) {
+		_ArenaBlock *next = pool->blocks->next;
+		alloc_free(pool->parent, pool->blocks);
+		pool->blocks = next;
+	}
+	alloc_free(pool->parent, pool);
+}
+
+Allocator *pool_allocator(Pool *pool) {
+	return &pool->allocator;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+static void *_default_alloc(void *ctx, size_t size) {
+	(void)ctx;
+	return malloc(size);
+}
+
+static void *_default_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+	(void)ctx;
+	(void)old_size;
+	return realloc(ptr, new_size);
+}
+
+static void _default_free(void *ctx, void *ptr) {
+	(void)ctx;
+	free(ptr);
+}
+
+// allocates an empty block with room for capacity bytes
+static _ArenaBlock *_block_create(Allocator *parent, size_t capacity) {
+	_ArenaBlock *block = alloc_malloc(parent, sizeof(_ArenaBlock) + capacity);
+	if (!block) {
+		printf("failed to allocate arena block");
+		return NULL;
+	}
+	block->next = NULL;
+	block->used = 0;
+	block->capacity = capacity;
+	return block;
+}
+
+static void *_arena_alloc(void *ctx, size_t size) {
+	Arena *arena = ctx;
+	size = ALLOC_ROUND(size ? size : 1);
+	_ArenaBlock *block = arena->blocks;
+	if (block && block->capacity - block->used >= size) {
+		void *ptr = block->bytes + block->used;
+		block->used += size;
+		arena->last = ptr;
+		return ptr;
+	}
+	if (size > arena->block_size) {
+		// gets a block of its own, behind the current one so that one keeps filling up
+		_ArenaBlock *own = _block_create(arena->parent, size);
+		if (!own) {
+			return NULL;
+		}
+		own->used = size;
+		arena->bytes_reserved += sizeof(_ArenaBlock) + size;
+		if (block) {
+			own->next = block->next;
+			block->next = own;
+		}
+		else {
+			arena->blocks = own;
+			arena->last = NULL;
+		}
+		return own->bytes;
+	}
+	block = _block_create(arena->parent, arena->block_size);
+	if (!block) {
+		return NULL;
+	}
+	// growing geometrically keeps the number of blocks, and so the cost of freeing them, logarithmic
+	if (arena->block_size < ARENA_MAX_BLOCK) {
+		arena->block_size *= 2;
+	}
+	block->next = arena->blocks;
+	arena->blocks = block;
+	arena->bytes_reserved += sizeof(_ArenaBlock) + block->capacity;
+	block->used = size;
+	arena->last = block->bytes;
+	return block->bytes;
+}
+
+static void *_arena_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+	Arena *arena = ctx;
+	if (!ptr) {
+		return _arena_alloc(ctx, new_size);
+	}
+	if (ptr == arena->last) {
+		// the newest allocation is at the end of the current block, so it can grow or shrink in place
+		_ArenaBlock *block = arena->blocks;
+		size_t start = (unsigned char *)ptr - block->bytes;
+		size_t size = ALLOC_ROUND(new_size ? new_size : 1);
+		if (start + size <= block->capacity) {
+			block->used = start + size;
+			return ptr;
+		}
+	}
+	void *new_ptr = _arena_alloc(ctx, new_size);
+	if (new_ptr) {
+		memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+	}
+	return new_ptr;
+}
+
+// only the newest allocation can be given back. everything else waits for arena_reset
+static void _arena_free(void *ctx, void *ptr) {
+	Arena *arena = ctx;
+	if (ptr && ptr == arena->last) {
+		arena->blocks->used = (unsigned char *)ptr - arena->blocks->bytes;
+		arena->last = NULL;
+	}
+}
+
+static void *_pool_alloc(void *ctx, size_t size) {
+	Pool *pool = ctx;
+	if (size > pool->item_size) {
+		return alloc_malloc(pool->parent, size);
+	}
+	if (pool->free_list) {
+		void *slot = pool->free_list;
+		pool->free_list = *(void **)slot;
+		return slot;
+	}
+	_ArenaBlock *block = pool->blocks;
+	if (!block || block->used == block->capacity) {
+		// blocks double, so there are few of them to search when a slot is given back
+		size_t capacity = pool->item_size * pool->items_per_block;
+		if (block && block->capacity < POOL_MAX_BLOCK) {
+			capacity = block->capacity * 2;
+		}
+		else if (block) {
+			capacity = block->capacity;
+		}
+		block = _block_create(pool->parent, capacity);
+		if (!block) {
+			return NULL;
+		}
+		block->next = pool->blocks;
+		pool->blocks = block;
+		pool->bytes_reserved += sizeof(_ArenaBlock) + capacity;
+	}
+	void *slot = block->bytes + block->used;
+	block->used += pool->item_size;
+	return slot;
+}
+
+static void *_pool_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+	Pool *pool = ctx;
+	if (ptr && new_size <= pool->item_size && _pool_owner(pool, ptr)) {
+		return ptr;
+	}
+	void *new_ptr = _pool_alloc(ctx, new_size);
+	if (new_ptr && ptr) {
+		memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+		_pool_free(ctx, ptr);
+	}
+	return new_ptr;
+}
+
+static void _pool_free(void *ctx, void *ptr) {
+	Pool *pool = ctx;
+	if (!ptr) {
+		return;
+	}
+	if (_pool_owner(pool, ptr)) {
+		*(void **)ptr = pool->free_list;
+		pool->free_list = ptr;
+	}
+	else {
+		alloc_free(pool->parent, ptr);
+	}
+}
+
+// returns the block ptr is a slot of, or NULL if it was passed on to the parent
+static _ArenaBlock *_pool_owner(Pool *pool, void *ptr) {
+	uintptr_t addr = (uintptr_t)ptr;
+	for (_ArenaBlock *block = pool->blocks; block; block = block->next) {
+		if (addr >= (uintptr_t)block->bytes && addr < (uintptr_t)block->bytes + block->capacity) {
+			return block;
+		}
+	}
+	return NULL;
+}
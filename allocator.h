@@ -0,0 +1,195 @@
+//---------------------------------------------------------
+// file:    allocator.h
+// author:  Jordan Hoffmann
+// brief:   Library for pluggable allocators used by the containers, with
+//          bump arena and fixed size pool implementations
+//---------------------------------------------------------
+
+#pragma once
+#include <stddef.h>
+#include <stdbool.h>
+
+// C linkage, so C++ code (i.e gds.hpp users) can make arenas and pools from the C library
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// every allocation an arena or pool hands out starts on a multiple of this
+#define ALLOC_ALIGN 16
+
+// options an Allocator can have (combine with |)
+typedef enum {
+	ALLOC_DEFAULT	= 0,
+	ALLOC_REGION	= 1 << 0,	// free is a no-op. memory only comes back all at once, when the region is dropped
+} AllocatorFlags;
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+typedef struct {
+	void *(*alloc)(void *ctx, size_t size);									// returns size bytes (or NULL)
+	void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);	// resizes an allocation, keeping its bytes
+	void (*free)(void *ctx, void *ptr);										// gives an allocation back (ptr may be NULL)
+	void *ctx;																// handed to every call
+	int flags;																// AllocatorFlags
+} Allocator;
+
+// one block of an arena. blocks are chained newest first
+typedef struct _ArenaBlock {
+	struct _ArenaBlock *next;	// previous (full) block
+	size_t used;				// bytes handed out from this block
+	size_t capacity;			// bytes available in this block
+	size_t pad;					// keeps bytes aligned to ALLOC_ALIGN
+	unsigned char bytes[];		// the memory handed out
+} _ArenaBlock;
+
+typedef struct {
+	Allocator allocator;		// hands out memory from this arena (see arena_allocator)
+	Allocator *parent;			// where blocks come from (or NULL for malloc)
+	_ArenaBlock *blocks;		// newest block first
+	size_t block_size;			// size of the next regular block. doubles every block up to a limit
+	void *last;					// most recent allocation, which can still grow or be given back
+	size_t bytes_reserved;		// bytes held by all blocks
+} Arena;
+
+typedef struct {
+	Allocator allocator;		// hands out memory from this pool (see pool_allocator)
+	Allocator *parent;			// where blocks and oversized allocations come from (or NULL for malloc)
+	size_t item_size;			// size of every slot
+	int items_per_block;		// slots in every block
+	void *free_list;			// slots given back, each holding a pointer to the next one
+	_ArenaBlock *blocks;		// newest block first
+	size_t bytes_reserved;		// bytes held by all blocks
+} Pool;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		returns the allocator that uses malloc, realloc and free
+* @details		containers given a NULL allocator use this one.
+*
+* @return		a pointer to the shared default allocator
+*/
+Allocator *alloc_default(void);
+
+/**
+* @brief		allocates size bytes from an allocator
+*
+* @param[in]	allocator - the allocator to use, or NULL for malloc
+* @param[in]	size	  - the number of bytes to allocate
+* @return		the new memory, or NULL if it couldn't be allocated
+*/
+void *alloc_malloc(Allocator *allocator, size_t size);
+
+/**
+* @brief		resizes memory from an allocator, keeping its bytes
+* @details		allocators that don't remember sizes need the old one to copy from.
+*
+* @param[in]	allocator - the allocator ptr came from, or NULL for realloc
+* @param[in]	ptr		  - the memory to resize (or NULL)
+* @param[in]	old_size  - the size ptr was allocated with
+* @param[in]	new_size  - the size it should be
+* @return		the resized memory, or NULL (leaving ptr alone) if it couldn't be allocated
+*/
+void *alloc_realloc(Allocator *allocator, void *ptr, size_t old_size, size_t new_size);
+
+/**
+* @brief		gives memory back to the allocator it came from
+*
+* @param[in]	allocator - the allocator ptr came from, or NULL for free
+* @param[in]	ptr		  - the memory to give back (or NULL)
+*/
+void alloc_free(Allocator *allocator, void *ptr);
+
+/**
+* @brief		boolian function used to determine weather an allocator is a region
+* @details		giving memory back to a region does nothing, so containers on one skip
+*				walking their nodes when they are freed without a free_func.
+*
+* @param[in]	allocator - the allocator to check (NULL is malloc, which isn't one)
+* @return		1 if the allocator has ALLOC_REGION, 0 if it doesn't
+*/
+bool alloc_is_region(Allocator *allocator);
+
+/**
+* @brief		Allocates and initializes a new Arena ptr
+* @details		an arena hands out memory by bumping a pointer through big blocks. giving
+*				memory back does nothing (except for the most recent allocation), and
+*				everything is released at once by arena_reset or arena_free. put short lived
+*				containers on one and free the arena instead of every node.
+*				blocks double in size, so even a huge container sits in a few dozen blocks,
+*				and freeing it with its arena costs one free per block. its allocator is an
+*				ALLOC_REGION one.
+*
+* @param[in]	block_size - the size of the first block. i.e 65536
+* @param[in]	parent	   - the allocator blocks come from, or NULL for malloc
+* @return		a pointer to a newly allocated and empty arena
+*/
+Arena *arena_create(size_t block_size, Allocator *parent);
+
+/**
+* @brief		frees an arena and everything allocated from it
+*
+* @param[in]	arena - the arena to free
+*/
+void arena_free(Arena *arena);
+
+/**
+* @brief		releases everything allocated from an arena, keeping one block for reuse
+* @details		the biggest regular block is kept, so an arena reused for similar work
+*				doesn't need to allocate again.
+*
+* @param[in]	arena - the arena to reset
+*/
+void arena_reset(Arena *arena);
+
+/**
+* @brief		returns an allocator that hands out memory from an arena
+* @details		it is stored inside the arena, so it lives exactly as long as the arena.
+*
+* @param[in]	arena - the arena to allocate from
+* @return		the arena's allocator
+*/
+Allocator *arena_allocator(Arena *arena);
+
+/**
+* @brief		Allocates and initializes a new Pool ptr
+* @details		a pool hands out slots of one size from big blocks and keeps the ones given
+*				back on a free list, so allocating and freeing are a couple of pointer moves.
+*				requests bigger than item_size are passed on to parent. made for containers
+*				that allocate lots of equal sized nodes, like a LinkedList.
+*
+* @param[in]	item_size		- the size of every slot
+* @param[in]	items_per_block - the number of slots in the first block. later blocks double
+* @param[in]	parent			- the allocator blocks come from, or NULL for malloc
+* @return		a pointer to a newly allocated and empty pool
+*/
+Pool *pool_create(size_t item_size, int items_per_block, Allocator *parent);
+
+/**
+* @brief		frees a pool and every slot allocated from it
+* @details		oversized allocations passed on to the parent are not tracked, so free those first.
+*
+* @param[in]	pool - the pool to free
+*/
+void pool_free(Pool *pool);
+
+/**
+* @brief		returns an allocator that hands out memory from a pool
+* @details		it is stored inside the pool, so it lives exactly as long as the pool.
+*
+* @param[in]	pool - the pool to allocate from
+* @return		the pool's allocator
+*/
+Allocator *pool_allocator(Pool *pool);
+
+#ifdef __cplusplus
+}
+#endif
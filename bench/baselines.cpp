@@ -0,0 +1,389 @@
+//---------------------------------------------------------
+// file:    baselines.cpp
+// author:  Jordan Hoffmann
+// brief:   the C++ standard library containers the benchmark suite
+//          compares DynArr, LinkedList, HashTable and heaps against, and the
+//          gds.hpp templates that sit between the two
+//---------------------------------------------------------
+
+#include "bench.h"
+#include "gds.hpp"
+#include <vector>
+#include <deque>
+#include <list>
+#include <queue>
+#include <string>
+#include <unordered_map>
+
+//---------------------------------------------------------
+// std::vector, next to DynArr
+//---------------------------------------------------------
+
+static std::vector<int> vector_build(int n) {
+	std::vector<int> vec;
+	for (int i = 0; i < n; i++) {
+		vec.push_back(i);
+	}
+	return vec;
+}
+
+static void vector_push(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		std::vector<int> vec = vector_build(in->n);
+		bench_pause();
+	}
+}
+
+static void vector_get(BenchInput *in) {
+	std::vector<int> vec = vector_build(in->n);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int i = 0; i < in->n; i++) {
+			sum += vec[in->order[i]];
+		}
+	}
+	bench_pause();
+	bench_sink = sum;
+}
+
+static void vector_iterate(BenchInput *in) {
+	std::vector<int> vec = vector_build(in->n);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int item : vec) {
+			sum += item;
+		}
+	}
+	bench_pause();
+	bench_sink = sum;
+}
+
+static void vector_remove(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		std::vector<int> vec = vector_build(in->n);
+		bench_resume();
+		for (int i = 0; i < in->n; i++) {
+			vec.pop_back();
+		}
+		bench_pause();
+	}
+}
+
+static gds::DynArr<int> dynarr_build(int n) {
+	gds::DynArr<int> arr;
+	for (int i = 0; i < n; i++) {
+		arr.push(i);
+	}
+	return arr;
+}
+
+static void gds_dynarr_push(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		gds::DynArr<int> arr = dynarr_build(in->n);
+		bench_pause();
+	}
+}
+
+static void gds_dynarr_get(BenchInput *in) {
+	gds::DynArr<int> arr = dynarr_build(in->n);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int i = 0; i < in->n; i++) {
+			sum += arr[in->order[i]];
+		}
+	}
+	bench_pause();
+	bench_sink = sum;
+}
+
+static void gds_dynarr_iterate(BenchInput *in) {
+	gds::DynArr<int> arr = dynarr_build(in->n);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int item : arr) {
+			sum += item;
+		}
+	}
+	bench_pause();
+	bench_sink = sum;
+}
+
+static void gds_dynarr_remove(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		gds::DynArr<int> arr = dynarr_build(in->n);
+		bench_resume();
+		for (int i = 0; i < in->n; i++) {
+			arr.rem_back();
+		}
+		bench_pause();
+	}
+}
+
+//---------------------------------------------------------
+// std::deque, std::list and gds::List, next to LinkedList
+//---------------------------------------------------------
+
+template <typename Seq>
+static void seq_push(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		{
+			Seq seq;
+			for (int i = 0; i < in->n; i++) {
+				seq.push_back(i);
+			}
+			bench_pause();
+		}
+	}
+}
+
+template <typename Seq>
+static void seq_pop(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		Seq seq;
+		for (int i = 0; i < in->n; i++) {
+			seq.push_back(i);
+		}
+		bench_resume();
+		for (int i = 0; i < in->n; i++) {
+			seq.pop_front();
+		}
+		bench_pause();
+	}
+}
+
+template <typename Seq>
+static void seq_iterate(BenchInput *in) {
+	Seq seq;
+	for (int i = 0; i < in->n; i++) {
+		seq.push_back(i);
+	}
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int item : seq) {
+			sum += item;
+		}
+	}
+	bench_pause();
+	bench_sink = sum;
+}
+
+//---------------------------------------------------------
+// std::unordered_map and gds::HashMap, next to HashTable
+//---------------------------------------------------------
+
+// keys are turned into std::strings before the clock starts, the way a C++ caller would hold them
+static std::vector<std::string> map_keys(char **keys, int n) {
+	return std::vector<std::string>(keys, keys + n);
+}
+
+template <typename Map>
+static void map_build(Map &map, std::vector<std::string> &keys) {
+	for (size_t i = 0; i < keys.size(); i++) {
+		map.emplace(keys[i], (int)i);
+	}
+}
+
+// the lookups the two maps don't spell the same way
+static int map_get(std::unordered_map<std::string, int> &map, const std::string &key) {
+	return map.find(key)->second;
+}
+
+static int map_get(gds::HashMap<std::string, int> &map, const std::string &key) {
+	return *map.find(key);
+}
+
+static bool map_has(std::unordered_map<std::string, int> &map, const std::string &key) {
+	return map.count(key) != 0;
+}
+
+static bool map_has(gds::HashMap<std::string, int> &map, const std::string &key) {
+	return map.exists(key);
+}
+
+static void map_erase(std::unordered_map<std::string, int> &map, const std::string &key) {
+	map.erase(key);
+}
+
+static void map_erase(gds::HashMap<std::string, int> &map, const std::string &key) {
+	map.rem(key);
+}
+
+template <typename Map>
+static void map_insert(BenchInput *in) {
+	std::vector<std::string> keys = map_keys(in->keys, in->n);
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		{
+			Map map;
+			map.reserve(in->n);
+			map_build(map, keys);
+			bench_pause();
+		}
+	}
+}
+
+template <typename Map>
+static void map_grow(BenchInput *in) {
+	std::vector<std::string> keys = map_keys(in->keys, in->n);
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		{
+			Map map;
+			map_build(map, keys);
+			bench_pause();
+		}
+	}
+}
+
+template <typename Map>
+static void map_hit(BenchInput *in) {
+	std::vector<std::string> keys = map_keys(in->keys, in->n);
+	Map map;
+	map_build(map, keys);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int i = 0; i < in->n; i++) {
+			sum += map_get(map, keys[in->order[i]]);
+		}
+	}
+	bench_pause();
+	bench_sink = sum;
+}
+
+template <typename Map>
+static void map_miss(BenchInput *in) {
+	std::vector<std::string> keys = map_keys(in->keys, in->n);
+	std::vector<std::string> miss_keys = map_keys(in->miss_keys, in->n);
+	Map map;
+	map_build(map, keys);
+	long long found = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int i = 0; i < in->n; i++) {
+			found += map_has(map, miss_keys[i]);
+		}
+	}
+	bench_pause();
+	bench_sink = found;
+}
+
+template <typename Map>
+static void map_remove(BenchInput *in) {
+	std::vector<std::string> keys = map_keys(in->keys, in->n);
+	for (int r = 0; r < in->reps; r++) {
+		Map map;
+		map_build(map, keys);
+		bench_resume();
+		for (int i = 0; i < in->n; i++) {
+			map_erase(map, keys[i]);
+		}
+		bench_pause();
+	}
+}
+
+//---------------------------------------------------------
+// std::priority_queue, next to the heaps
+//---------------------------------------------------------
+
+// a min heap, like the ones bench.c times
+typedef std::priority_queue<int, std::vector<int>, std::greater<int> > MinQueue;
+
+static void queue_push(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		{
+			MinQueue queue;
+			for (int i = 0; i < in->n; i++) {
+				queue.push(in->order[i]);
+			}
+			bench_pause();
+		}
+	}
+}
+
+static void queue_pop(BenchInput *in) {
+	long long sum = 0;
+	for (int r = 0; r < in->reps; r++) {
+		// made from the whole array at once, like name_heapify
+		MinQueue queue(std::greater<int>(), std::vector<int>(in->order, in->order + in->n));
+		bench_resume();
+		while (!queue.empty()) {
+			sum += queue.top();
+			queue.pop();
+		}
+		bench_pause();
+	}
+	bench_sink = sum;
+}
+
+// keeps the BENCH_TOP_K largest, the usual way: push, then pop whenever there's one too many
+static void queue_top_k(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		{
+			MinQueue queue;
+			for (int i = 0; i < in->n; i++) {
+				if ((int)queue.size() < BENCH_TOP_K) {
+					queue.push(in->order[i]);
+				}
+				else if (queue.top() < in->order[i]) {
+					queue.pop();
+					queue.push(in->order[i]);
+				}
+			}
+			bench_pause();
+			bench_sink = queue.top();
+		}
+	}
+}
+
+typedef std::unordered_map<std::string, int> StringMap;
+typedef gds::HashMap<std::string, int> GdsStringMap;
+
+//---------------------------------------------------------
+// Public Variables:
+//---------------------------------------------------------
+
+extern "C" const BenchCase bench_baselines[] = {
+	{ "std::vector", "push", false, false, vector_push },
+	{ "std::vector", "get", true, false, vector_get },
+	{ "std::vector", "iterate", false, false, vector_iterate },
+	{ "std::vector", "remove", false, false, vector_remove },
+	{ "std::deque", "push", false, false, seq_push<std::deque<int> > },
+	{ "std::deque", "pop", false, false, seq_pop<std::deque<int> > },
+	{ "std::deque", "iterate", false, false, seq_iterate<std::deque<int> > },
+	{ "std::list", "push", false, false, seq_push<std::list<int> > },
+	{ "std::list", "pop", false, false, seq_pop<std::list<int> > },
+	{ "std::list", "iterate", false, false, seq_iterate<std::list<int> > },
+	{ "std::unordered_map", "insert", false, true, map_insert<StringMap> },
+	{ "std::unordered_map", "grow", false, true, map_grow<StringMap> },
+	{ "std::unordered_map", "hit", true, true, map_hit<StringMap> },
+	{ "std::unordered_map", "miss", false, true, map_miss<StringMap> },
+	{ "std::unordered_map", "remove", false, true, map_remove<StringMap> },
+	{ "std::priority_queue", "push", true, false, queue_push },
+	{ "std::priority_queue", "pop", true, false, queue_pop },
+	{ "std::priority_queue", "top-k", true, false, queue_top_k },
+	{ "gds::DynArr", "push", false, false, gds_dynarr_push },
+	{ "gds::DynArr", "get", true, false, gds_dynarr_get },
+	{ "gds::DynArr", "iterate", false, false, gds_dynarr_iterate },
+	{ "gds::DynArr", "remove", false, false, gds_dynarr_remove },
+	{ "gds::List", "push", false, false, seq_push<gds::List<int> > },
+	{ "gds::List", "pop", false, false, seq_pop<gds::List<int> > },
+	{ "gds::List", "iterate", false, false, seq_iterate<gds::List<int> > },
+	{ "gds::HashMap", "insert", false, true, map_insert<GdsStringMap> },
+	{ "gds::HashMap", "grow", false, true, map_grow<GdsStringMap> },
+	{ "gds::HashMap", "hit", true, true, map_hit<GdsStringMap> },
+	{ "gds::HashMap", "miss", false, true, map_miss<GdsStringMap> },
+	{ "gds::HashMap", "remove", false, true, map_remove<GdsStringMap> },
+};
+
+extern "C" const int bench_baseline_count = sizeof(bench_baselines) / sizeof(bench_baselines[0]);
@@ -0,0 +1,780 @@
+//---------------------------------------------------------
+// file:    bench.c
+// author:  Jordan Hoffmann
+// brief:   microbenchmarks for DynArr, LinkedList, HashTable, heaps and
+//          flat maps next to
+//          the C++ standard library, reporting ns/op, allocations/op and
+//          peak RSS as CSV or JSON
+//---------------------------------------------------------
+
+#include "bench.h"
+#include "../data_structures.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#define BENCH_FORK 1
+#elif defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// the biggest size run unless --max says otherwise
+#define BENCH_MAX_SIZE 10000000
+
+// keys are at most this long, including the '\0'
+#define BENCH_KEY_SIZE 16
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+#define _bench_int_less(a, b) ((a) < (b))
+HEAP_DECLARE(BenchHeap2, int);
+HEAP_DEFINE(BenchHeap2, int, _bench_int_less, 2);
+HEAP_DECLARE(BenchHeap4, int);
+HEAP_DEFINE(BenchHeap4, int, _bench_int_less, 4);
+
+#define _bench_str_less(a, b) (strcmp(a, b) < 0)
+FLATMAP_DECLARE(BenchFlat, char *, int);
+FLATMAP_DEFINE(BenchFlat, char *, int, _bench_str_less);
+
+typedef struct {
+	const char *structure;
+	const char *op;
+	int size;
+	BenchDist dist;
+	double ns_per_op;
+	double allocs_per_op;			// -1 when allocations can't be counted
+	long long peak_rss_kb;			// -1 when it can't be measured
+} BenchResult;
+
+typedef struct {
+	int min_size;
+	int max_size;
+	const char *filter;				// only cases whose "structure op" contains this (or NULL)
+	bool json;
+	bool fork;						// run every case in its own process, so peak RSS is its own
+	FILE *out;
+} BenchOptions;
+
+//---------------------------------------------------------
+// Public Variables:
+//---------------------------------------------------------
+
+volatile long long bench_sink;
+
+//---------------------------------------------------------
+// Private Variables:
+//---------------------------------------------------------
+
+static const char *dist_names[BENCH_DIST_COUNT] = { "sequential", "uniform", "zipf" };
+
+static double clock_total;			// seconds counted since the case started
+static double clock_start;			// when the clock was last resumed
+static long long alloc_total;		// allocations counted since the case started
+static long long alloc_calls;		// allocations ever made by the process
+static long long alloc_start;		// alloc_calls when the counter was last resumed
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ull;
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static double _bench_now(void);
+static unsigned long long _bench_rand(void);
+static void _bench_shuffle(int *order, int n);
+static void _bench_zipf(int *order, int n);
+static bool _bench_make_input(BenchInput *in, int n, BenchDist dist, bool uses_keys);
+static void _bench_free_input(BenchInput *in);
+static long long _bench_peak_rss_kb(void);
+static void _bench_measure(const BenchCase *c, int n, BenchDist dist, BenchResult *result);
+static bool _bench_run(const BenchCase *c, int n, BenchDist dist, BenchOptions *options, BenchResult *result);
+static void _bench_print(BenchOptions *options, BenchResult *result, bool first);
+
+static void _dna_push(BenchInput *in);
+static void _dna_get(BenchInput *in);
+static void _dna_iterate(BenchInput *in);
+static void _dna_remove(BenchInput *in);
+static void _sll_push(BenchInput *in);
+static void _sll_pop(BenchInput *in);
+static void _sll_iterate(BenchInput *in);
+static void _dll_push(BenchInput *in);
+static void _dll_pop(BenchInput *in);
+static void _dll_iterate(BenchInput *in);
+static void _hash_insert(BenchInput *in);
+static void _hash_grow(BenchInput *in);
+static void _hash_hit(BenchInput *in);
+static void _hash_miss(BenchInput *in);
+static void _hash_remove(BenchInput *in);
+static void _heap2_push(BenchInput *in);
+static void _heap2_pop(BenchInput *in);
+static void _heap2_top_k(BenchInput *in);
+static void _heap4_push(BenchInput *in);
+static void _heap4_pop(BenchInput *in);
+static void _heap4_top_k(BenchInput *in);
+static void _flat_build(BenchInput *in);
+static void _flat_hit(BenchInput *in);
+static void _flat_miss(BenchInput *in);
+static void _flat_iterate(BenchInput *in);
+
+static const BenchCase bench_cases[] = {
+	{ "DynArr", "push", false, false, _dna_push },
+	{ "DynArr", "get", true, false, _dna_get },
+	{ "DynArr", "iterate", false, false, _dna_iterate },
+	{ "DynArr", "remove", false, false, _dna_remove },
+	{ "LinkedList(singly)", "push", false, false, _sll_push },
+	{ "LinkedList(singly)", "pop", false, false, _sll_pop },
+	{ "LinkedList(singly)", "iterate", false, false, _sll_iterate },
+	{ "LinkedList(doubly)", "push", false, false, _dll_push },
+	{ "LinkedList(doubly)", "pop", false, false, _dll_pop },
+	{ "LinkedList(doubly)", "iterate", false, false, _dll_iterate },
+	{ "HashTable", "insert", false, true, _hash_insert },
+	{ "HashTable", "grow", false, true, _hash_grow },
+	{ "HashTable", "hit", true, true, _hash_hit },
+	{ "HashTable", "miss", false, true, _hash_miss },
+	{ "HashTable", "remove", false, true, _hash_remove },
+	{ "Heap(binary)", "push", true, false, _heap2_push },
+	{ "Heap(binary)", "pop", true, false, _heap2_pop },
+	{ "Heap(binary)", "top-k", true, false, _heap2_top_k },
+	{ "Heap(4-ary)", "push", true, false, _heap4_push },
+	{ "Heap(4-ary)", "pop", true, false, _heap4_pop },
+	{ "Heap(4-ary)", "top-k", true, false, _heap4_top_k },
+	{ "FlatMap", "build", false, true, _flat_build },
+	{ "FlatMap", "hit", true, true, _flat_hit },
+	{ "FlatMap", "miss", false, true, _flat_miss },
+	{ "FlatMap", "iterate", false, true, _flat_iterate },
+};
+
+//---------------------------------------------------------
+// allocation counting
+//---------------------------------------------------------
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+// the executable's malloc wins over libc's for every caller, the library and operator new included
+#define BENCH_COUNT_ALLOCS 1
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+	alloc_calls++;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+	alloc_calls++;
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+	alloc_calls++;
+	return __libc_realloc(ptr, size);
+}
+#endif
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+int main(int argc, char **argv) {
+	BenchOptions options = { 10, BENCH_MAX_SIZE, NULL, false, true, stdout };
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0) {
+			options.json = true;
+		}
+		else if (strcmp(argv[i], "--csv") == 0) {
+			options.json = false;
+		}
+		else if (strcmp(argv[i], "--no-fork") == 0) {
+			options.fork = false;
+		}
+		else if (strcmp(argv[i], "--min") == 0 && i + 1 < argc) {
+			options.min_size = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+			options.max_size = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			options.filter = argv[++i];
+		}
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			options.out = fopen(argv[++i], "w");
+			if (!options.out) {
+				fprintf(stderr, "can't open %s\n", argv[i]);
+				return 1;
+			}
+		}
+		else {
+			fprintf(stderr,
+				"usage: %s [--csv | --json] [--out file] [--min size] [--max size] [--filter text] [--no-fork]\n"
+				"  sizes go up by 10x from --min (10) to --max (%d)\n"
+				"  --filter runs only cases whose \"structure op\" contains text, i.e \"HashTable hit\"\n",
+				argv[0], BENCH_MAX_SIZE);
+			return 1;
+		}
+	}
+
+	int case_count = sizeof(bench_cases) / sizeof(bench_cases[0]);
+	bool first = true;
+	if (options.json) {
+		fprintf(options.out, "[\n");
+	}
+	for (int n = options.min_size > 0 ? options.min_size : 1; n <= options.max_size; n *= 10) {
+		// the library's cases first, then the baselines, so results for one size sit together
+		for (int i = 0; i < case_count + bench_baseline_count; i++) {
+			const BenchCase *c = i < case_count ? &bench_cases[i] : &bench_baselines[i - case_count];
+			if (options.filter) {
+				char name[128];
+				snprintf(name, sizeof(name), "%s %s", c->structure, c->op);
+				if (!strstr(name, options.filter)) {
+					continue;
+				}
+			}
+			int dists = c->uses_dist ? BENCH_DIST_COUNT : 1;
+			for (int d = 0; d < dists; d++) {
+				BenchResult result;
+				if (_bench_run(c, n, (BenchDist)d, &options, &result)) {
+					_bench_print(&options, &result, first);
+					first = false;
+				}
+			}
+		}
+		if (n > options.max_size / 10) {
+			break;
+		}
+	}
+	if (options.json) {
+		fprintf(options.out, "\n]\n");
+	}
+	if (options.out != stdout) {
+		fclose(options.out);
+	}
+	return 0;
+}
+
+void bench_resume(void) {
+	alloc_start = alloc_calls;
+	clock_start = _bench_now();
+}
+
+void bench_pause(void) {
+	clock_total += _bench_now() - clock_start;
+	alloc_total += alloc_calls - alloc_start;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+static double _bench_now(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// splitmix64
+static unsigned long long _bench_rand(void) {
+	unsigned long long z = (rng_state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+static void _bench_shuffle(int *order, int n) {
+	for (int i = n - 1; i > 0; i--) {
+		int j = (int)(_bench_rand() % (unsigned long long)(i + 1));
+		int temp = order[i];
+		order[i] = order[j];
+		order[j] = temp;
+	}
+}
+
+/* fills order with n zipf distributed picks from [0, n), using the generator from Gray et al.,
+ * "Quickly Generating Billion-Record Synthetic Databases". ranks are mapped through a shuffle
+ * so the hot elements are spread out instead of all sitting at the front */
+static void _bench_zipf(int *order, int n) {
+	const double theta = 0.99;
+	int *rank_to_index = malloc(n * sizeof(int));
+	for (int i = 0; i < n; i++) {
+		rank_to_index[i] = i;
+	}
+	_bench_shuffle(rank_to_index, n);
+	double zetan = 0;
+	for (int i = 1; i <= n; i++) {
+		zetan += 1.0 / pow(i, theta);
+	}
+	double zeta2 = 1.0 + 1.0 / pow(2, theta);
+	double alpha = 1.0 / (1.0 - theta);
+	double eta = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+	for (int i = 0; i < n; i++) {
+		double u = (_bench_rand() >> 11) * (1.0 / 9007199254740992.0);
+		double uz = u * zetan;
+		long long rank;
+		if (uz < 1.0) {
+			rank = 0;
+		}
+		else if (uz < 1.0 + pow(0.5, theta)) {
+			rank = 1;
+		}
+		else {
+			rank = (long long)(n * pow(eta * u - eta + 1.0, alpha));
+		}
+		if (rank >= n) rank = n - 1;
+		order[i] = rank_to_index[rank];
+	}
+	free(rank_to_index);
+}
+
+static bool _bench_make_input(BenchInput *in, int n, BenchDist dist, bool uses_keys) {
+	memset(in, 0, sizeof(BenchInput));
+	in->n = n;
+	in->reps = n < BENCH_MIN_OPS ? (BENCH_MIN_OPS + n - 1) / n : 1;
+	in->dist = dist;
+	in->order = malloc(n * sizeof(int));
+	if (!in->order) {
+		return false;
+	}
+	if (dist == BENCH_ZIPF) {
+		_bench_zipf(in->order, n);
+	}
+	else {
+		for (int i = 0; i < n; i++) {
+			in->order[i] = i;
+		}
+		if (dist == BENCH_UNIFORM) {
+			_bench_shuffle(in->order, n);
+		}
+	}
+	if (uses_keys) {
+		// every key lives in one block, so making them doesn't skew the allocation counts
+		char *block = malloc((size_t)n * 2 * BENCH_KEY_SIZE);
+		in->keys = malloc(n * sizeof(char *));
+		in->miss_keys = malloc(n * sizeof(char *));
+		if (!block || !in->keys || !in->miss_keys) {
+			free(block);
+			return false;
+		}
+		for (int i = 0; i < n; i++) {
+			in->keys[i] = block + (size_t)i * BENCH_KEY_SIZE;
+			in->miss_keys[i] = block + ((size_t)n + i) * BENCH_KEY_SIZE;
+			snprintf(in->keys[i], BENCH_KEY_SIZE, "key:%d", i);
+			snprintf(in->miss_keys[i], BENCH_KEY_SIZE, "miss:%d", i);
+		}
+	}
+	return true;
+}
+
+static void _bench_free_input(BenchInput *in) {
+	if (in->keys) {
+		free(in->keys[0]);
+	}
+	free(in->keys);
+	free(in->miss_keys);
+	free(in->order);
+}
+
+static long long _bench_peak_rss_kb(void) {
+#if defined(BENCH_FORK)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return -1;
+	}
+#if defined(__APPLE__)
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#elif defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return -1;
+	}
+	return (long long)(counters.PeakWorkingSetSize / 1024);
+#else
+	return -1;
+#endif
+}
+
+// runs one case in this process
+static void _bench_measure(const BenchCase *c, int n, BenchDist dist, BenchResult *result) {
+	BenchInput in;
+	result->ns_per_op = -1;
+	result->allocs_per_op = -1;
+	result->peak_rss_kb = -1;
+	if (!_bench_make_input(&in, n, dist, c->uses_keys)) {
+		fprintf(stderr, "not enough memory for %s %s at %d\n", c->structure, c->op, n);
+		return;
+	}
+	clock_total = 0;
+	alloc_total = 0;
+	(*c->run)(&in);
+	double ops = (double)n * in.reps;
+	result->ns_per_op = clock_total * 1e9 / ops;
+#if defined(BENCH_COUNT_ALLOCS)
+	result->allocs_per_op = alloc_total / ops;
+#endif
+	result->peak_rss_kb = _bench_peak_rss_kb();
+	_bench_free_input(&in);
+}
+
+// runs one case, in a child process when possible so its peak RSS isn't mixed up with the others
+static bool _bench_run(const BenchCase *c, int n, BenchDist dist, BenchOptions *options, BenchResult *result) {
+	result->structure = c->structure;
+	result->op = c->op;
+	result->size = n;
+	result->dist = c->uses_dist ? dist : BENCH_DIST_COUNT;
+#if defined(BENCH_FORK)
+	if (options->fork) {
+		int fds[2];
+		if (pipe(fds) == 0) {
+			fflush(options->out);
+			pid_t pid = fork();
+			if (pid == 0) {
+				close(fds[0]);
+				_bench_measure(c, n, dist, result);
+				ssize_t written = write(fds[1], result, sizeof(BenchResult));
+				_exit(written == sizeof(BenchResult) ? 0 : 1);
+			}
+			close(fds[1]);
+			bool ok = false;
+			if (pid > 0) {
+				ok = read(fds[0], result, sizeof(BenchResult)) == sizeof(BenchResult);
+				waitpid(pid, NULL, 0);
+			}
+			close(fds[0]);
+			if (!ok) {
+				fprintf(stderr, "%s %s at %d didn't finish\n", c->structure, c->op, n);
+			}
+			return ok;
+		}
+	}
+#endif
+	_bench_measure(c, n, dist, result);
+	return result->ns_per_op >= 0;
+}
+
+static void _bench_print(BenchOptions *options, BenchResult *result, bool first) {
+	const char *dist = result->dist < BENCH_DIST_COUNT ? dist_names[result->dist] : "-";
+	if (options->json) {
+		fprintf(options->out,
+			"%s  {\"structure\": \"%s\", \"op\": \"%s\", \"size\": %d, \"dist\": \"%s\", "
+			"\"ns_per_op\": %.3f, \"allocs_per_op\": %.3f, \"peak_rss_kb\": %lld}",
+			first ? "" : ",\n", result->structure, result->op, result->size, dist,
+			result->ns_per_op, result->allocs_per_op, result->peak_rss_kb);
+	}
+	else {
+		if (first) {
+			fprintf(options->out, "structure,op,size,dist,ns_per_op,allocs_per_op,peak_rss_kb\n");
+		}
+		fprintf(options->out, "%s,%s,%d,%s,%.3f,%.3f,%lld\n", result->structure, result->op,
+			result->size, dist, result->ns_per_op, result->allocs_per_op, result->peak_rss_kb);
+	}
+	fflush(options->out);
+}
+
+//---------------------------------------------------------
+// DynArr cases
+//---------------------------------------------------------
+
+static DynArr *_dna_build(int n) {
+	DynArr *arr = dna_create();
+	for (int i = 0; i < n; i++) {
+		DNA_PUSH(int, arr, i);
+	}
+	return arr;
+}
+
+static void _dna_push(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		DynArr *arr = _dna_build(in->n);
+		bench_pause();
+		dna_free(arr, 1, NULL);
+	}
+}
+
+static void _dna_get(BenchInput *in) {
+	DynArr *arr = _dna_build(in->n);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int i = 0; i < in->n; i++) {
+			sum += DNA_GET(int, arr, in->order[i]);
+		}
+	}
+	bench_pause();
+	bench_sink = sum;
+	dna_free(arr, 1, NULL);
+}
+
+static void _dna_iterate(BenchInput *in) {
+	DynArr *arr = _dna_build(in->n);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		DNA_FOREACH(int, item, arr, sum += item);
+	}
+	bench_pause();
+	bench_sink = sum;
+	dna_free(arr, 1, NULL);
+}
+
+static void _dna_remove(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		DynArr *arr = _dna_build(in->n);
+		bench_resume();
+		for (int i = 0; i < in->n; i++) {
+			dna_rem_back(arr, NULL);
+		}
+		bench_pause();
+		dna_free(arr, 1, NULL);
+	}
+}
+
+//---------------------------------------------------------
+// LinkedList cases
+//---------------------------------------------------------
+
+static LinkedList *_link_build(LinkedListType type, int n) {
+	LinkedList *list = link_create(type);
+	for (int i = 0; i < n; i++) {
+		LINK_PUSH_BACK(int, list, i);
+	}
+	return list;
+}
+
+static void _link_push(BenchInput *in, LinkedListType type) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		LinkedList *list = _link_build(type, in->n);
+		bench_pause();
+		link_free(list, NULL);
+	}
+}
+
+static void _link_pop(BenchInput *in, LinkedListType type) {
+	for (int r = 0; r < in->reps; r++) {
+		LinkedList *list = _link_build(type, in->n);
+		bench_resume();
+		for (int i = 0; i < in->n; i++) {
+			link_rem_front(list, NULL);
+		}
+		bench_pause();
+		link_free(list, NULL);
+	}
+}
+
+static void _link_iterate(BenchInput *in, LinkedListType type) {
+	LinkedList *list = _link_build(type, in->n);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		LINK_FOREACH(int, item, list, sum += item);
+	}
+	bench_pause();
+	bench_sink = sum;
+	link_free(list, NULL);
+}
+
+static void _sll_push(BenchInput *in) { _link_push(in, SINGLY_LINKED_LIST); }
+static void _sll_pop(BenchInput *in) { _link_pop(in, SINGLY_LINKED_LIST); }
+static void _sll_iterate(BenchInput *in) { _link_iterate(in, SINGLY_LINKED_LIST); }
+static void _dll_push(BenchInput *in) { _link_push(in, DOUBLY_LINKED_LIST); }
+static void _dll_pop(BenchInput *in) { _link_pop(in, DOUBLY_LINKED_LIST); }
+static void _dll_iterate(BenchInput *in) { _link_iterate(in, DOUBLY_LINKED_LIST); }
+
+//---------------------------------------------------------
+// HashTable cases
+//---------------------------------------------------------
+
+static HashTable *_hash_build(BenchInput *in, int capacity) {
+	HashTable *table = hash_create_with_capacity(NULL, capacity, HASH_DEFAULT);
+	for (int i = 0; i < in->n; i++) {
+		HASH_ADD(int, table, i, (unsigned char *)in->keys[i]);
+	}
+	return table;
+}
+
+// adds into a table that was made big enough up front
+static void _hash_insert(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		HashTable *table = _hash_build(in, in->n);
+		bench_pause();
+		hash_free(table, NULL);
+	}
+}
+
+// adds into a table that starts small, so every grow is paid for along the way
+static void _hash_grow(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		HashTable *table = _hash_build(in, 0);
+		bench_pause();
+		hash_free(table, NULL);
+	}
+}
+
+static void _hash_hit(BenchInput *in) {
+	HashTable *table = _hash_build(in, 0);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int i = 0; i < in->n; i++) {
+			sum += HASH_FIND(int, table, (unsigned char *)in->keys[in->order[i]]);
+		}
+	}
+	bench_pause();
+	bench_sink = sum;
+	hash_free(table, NULL);
+}
+
+static void _hash_miss(BenchInput *in) {
+	HashTable *table = _hash_build(in, 0);
+	long long found = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int i = 0; i < in->n; i++) {
+			found += hash_exists(table, (unsigned char *)in->miss_keys[i]);
+		}
+	}
+	bench_pause();
+	bench_sink = found;
+	hash_free(table, NULL);
+}
+
+static void _hash_remove(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		HashTable *table = _hash_build(in, 0);
+		bench_resume();
+		for (int i = 0; i < in->n; i++) {
+			hash_rem(table, (unsigned char *)in->keys[i], NULL);
+		}
+		bench_pause();
+		hash_free(table, NULL);
+	}
+}
+
+//---------------------------------------------------------
+// Heap cases
+//---------------------------------------------------------
+
+// the priorities are order[], so the dist decides whether they arrive sorted, shuffled or mostly repeated
+#define _BENCH_HEAP_CASES(heap_t, prefix)													\
+	static void prefix##_push(BenchInput *in) {												\
+		for (int r = 0; r < in->reps; r++) {												\
+			bench_resume();																	\
+			heap_t *heap = heap_t##_create();												\
+			for (int i = 0; i < in->n; i++) {												\
+				heap_t##_push(heap, in->order[i]);											\
+			}																				\
+			bench_pause();																	\
+			heap_t##_free(heap);															\
+		}																					\
+	}																						\
+	static void prefix##_pop(BenchInput *in) {												\
+		long long sum = 0;																	\
+		for (int r = 0; r < in->reps; r++) {												\
+			heap_t *heap = heap_t##_heapify(in->order, in->n);								\
+			int item;																		\
+			bench_resume();																	\
+			while (heap_t##_pop(heap, &item)) {												\
+				sum += item;																\
+			}																				\
+			bench_pause();																	\
+			heap_t##_free(heap);															\
+		}																					\
+		bench_sink = sum;																	\
+	}																						\
+	static void prefix##_top_k(BenchInput *in) {											\
+		for (int r = 0; r < in->reps; r++) {												\
+			bench_resume();																	\
+			heap_t *heap = heap_t##_create_bounded(BENCH_TOP_K);							\
+			for (int i = 0; i < in->n; i++) {												\
+				heap_t##_offer(heap, in->order[i], NULL);									\
+			}																				\
+			bench_pause();																	\
+			bench_sink = *heap_t##_top(heap);												\
+			heap_t##_free(heap);															\
+		}																					\
+	}
+
+_BENCH_HEAP_CASES(BenchHeap2, _heap2)
+_BENCH_HEAP_CASES(BenchHeap4, _heap4)
+
+//---------------------------------------------------------
+// FlatMap cases
+//---------------------------------------------------------
+
+// one bulk build from the keys in the order they were made, which isn't sorted
+static BenchFlat *_flat_make(BenchInput *in) {
+	int *vals = malloc(in->n * sizeof(int));
+	if (!vals) {
+		return NULL;
+	}
+	for (int i = 0; i < in->n; i++) {
+		vals[i] = i;
+	}
+	BenchFlat *map = BenchFlat_build(in->keys, vals, in->n);
+	free(vals);
+	return map;
+}
+
+static void _flat_build(BenchInput *in) {
+	for (int r = 0; r < in->reps; r++) {
+		bench_resume();
+		BenchFlat *map = _flat_make(in);
+		bench_pause();
+		BenchFlat_free(map);
+	}
+}
+
+static void _flat_hit(BenchInput *in) {
+	BenchFlat *map = _flat_make(in);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int i = 0; i < in->n; i++) {
+			sum += *BenchFlat_find(map, in->keys[in->order[i]]);
+		}
+	}
+	bench_pause();
+	bench_sink = sum;
+	BenchFlat_free(map);
+}
+
+static void _flat_miss(BenchInput *in) {
+	BenchFlat *map = _flat_make(in);
+	long long found = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		for (int i = 0; i < in->n; i++) {
+			found += BenchFlat_exists(map, in->miss_keys[i]);
+		}
+	}
+	bench_pause();
+	bench_sink = found;
+	BenchFlat_free(map);
+}
+
+static void _flat_iterate(BenchInput *in) {
+	BenchFlat *map = _flat_make(in);
+	long long sum = 0;
+	bench_resume();
+	for (int r = 0; r < in->reps; r++) {
+		FLATMAP_FOREACH(char *, int, key, val, map, sum += val);
+	}
+	bench_pause();
+	bench_sink = sum;
+	BenchFlat_free(map);
+}
@@ -0,0 +1,82 @@
+//---------------------------------------------------------
+// file:    bench.h
+// author:  Jordan Hoffmann
+// brief:   shared pieces of the benchmark suite, used by the C cases
+//          and the C++ standard library baselines
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// cases on small sizes are repeated until they've done at least this many operations
+#define BENCH_MIN_OPS 1000000
+
+// how many items the top-k cases keep
+#define BENCH_TOP_K 100
+
+// orders keys and indexes are visited in
+typedef enum {
+	BENCH_SEQUENTIAL,	// 0, 1, 2 ... in the order they were made
+	BENCH_UNIFORM,		// every one equally likely, in a random order
+	BENCH_ZIPF,			// a few hot ones visited far more than the rest (zipf, s = 0.99)
+	BENCH_DIST_COUNT,
+} BenchDist;
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+// everything a case gets to work with. made before the clock starts
+typedef struct {
+	int n;					// number of elements the structure holds
+	int reps;				// number of times to repeat the operation on n elements
+	BenchDist dist;			// the order of order[]
+	int *order;				// n indexes in [0, n) in dist order
+	char **keys;			// n distinct '\0' terminated keys
+	char **miss_keys;		// n keys that are none of keys
+} BenchInput;
+
+typedef struct {
+	const char *structure;	// i.e "DynArr" or "std::vector"
+	const char *op;			// i.e "push"
+	bool uses_dist;			// run once per BenchDist, otherwise just BENCH_SEQUENTIAL
+	bool uses_keys;			// needs keys and miss_keys
+	void (*run)(BenchInput *in);	// does in->reps rounds of the operation, timed with bench_*
+} BenchCase;
+
+//---------------------------------------------------------
+// Public Variables:
+//---------------------------------------------------------
+
+// the C++ standard library baselines, defined in baselines.cpp
+extern const BenchCase bench_baselines[];
+extern const int bench_baseline_count;
+
+// written to by cases so the compiler can't drop the work being timed
+extern volatile long long bench_sink;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		starts (or resumes) the clock and the allocation counter
+*/
+void bench_resume(void);
+
+/**
+* @brief		stops the clock and the allocation counter, i.e around setup that shouldn't count
+*/
+void bench_pause(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+//---------------------------------------------------------
+// file:    bloomFilter.c
+// author:  Jordan Hoffmann
+// brief:   Library for blocked bloom filters, a fast check for keys that
+//          are definitely not in a set
+//---------------------------------------------------------
+
+#include "bloomFilter.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+#define BLOOM_BLOCK_WORDS (BLOOM_BLOCK_BITS / 64)
+#define BLOOM_ALIGN 64
+
+// block words are read and written whole, so one thread can add while others check.
+// adds are a load and a store rather than an atomic or, since only one thread adds at a time
+#if defined(__GNUC__) || defined(__clang__)
+#define BLOOM_LOAD(word) __atomic_load_n(word, __ATOMIC_RELAXED)
+#define BLOOM_STORE(word, val) __atomic_store_n(word, val, __ATOMIC_RELAXED)
+#else
+#define BLOOM_LOAD(word) (*(volatile uint64_t *)(word))
+#define BLOOM_STORE(word, val) (*(volatile uint64_t *)(word) = (val))
+#endif
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static uint64_t _bloom_mix(uint64_t h);
+static uint64_t _bloom_hash_key(unsigned char *key, int key_len);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+BloomFilter *bloom_create(int capacity, double fp_rate) {
+	if (capacity < 1) capacity = 1;
+	if (fp_rate <= 0 || fp_rate >= 1) fp_rate = 0.01;
+	BloomFilter *filter = malloc(sizeof(BloomFilter));
+	if (!filter) {
+		printf("failed to allocate bloom filter");
+		return NULL;
+	}
+	// the usual sizing for a plain bloom filter: -ln(p) / ln(2)^2 bits per key, ln(2) of them set
+	double bits_per_key = -log(fp_rate) / (0.6931471805599453 * 0.6931471805599453);
+	double bits = bits_per_key * capacity;
+	filter->capacity = capacity;
+	filter->count = 0;
+	filter->fp_rate = fp_rate;
+	filter->block_count = (int)ceil(bits / BLOOM_BLOCK_BITS);
+	if (filter->block_count < 1) filter->block_count = 1;
+	filter->hash_count = (int)(bits_per_key * 0.6931471805599453 + 0.5);
+	if (filter->hash_count < 1) filter->hash_count = 1;
+	if (filter->hash_count > BLOOM_MAX_HASHES) filter->hash_count = BLOOM_MAX_HASHES;
+
+	// blocks are aligned by hand so every one of them is exactly one cache line
+	size_t bytes = (size_t)filter->block_count * BLOOM_BLOCK_WORDS * sizeof(uint64_t);
+	filter->memory = malloc(bytes + BLOOM_ALIGN);
+	if (!filter->memory) {
+		printf("failed to allocate bloom filter blocks");
+		free(filter);
+		return NULL;
+	}
+	filter->blocks = (uint64_t *)(((uintptr_t)filter->memory + BLOOM_ALIGN - 1) & ~(uintptr_t)(BLOOM_ALIGN - 1));
+	memset(filter->blocks, 0, bytes);
+	return filter;
+}
+
+void bloom_free(BloomFilter *filter) {
+	if (filter) {
+		free(filter->memory);
+		free(filter);
+	}
+}
+
+void bloom_clear(BloomFilter *filter) {
+	memset(filter->blocks, 0, (size_t)filter->block_count * BLOOM_BLOCK_WORDS * sizeof(uint64_t));
+	filter->count = 0;
+}
+
+void bloom_add(BloomFilter *filter, unsigned char *key, int key_len) {
+	bloom_add_hash(filter, _bloom_hash_key(key, key_len));
+}
+
+bool bloom_maybe_contains(BloomFilter *filter, unsigned char *key, int key_len) {
+	return bloom_maybe_contains_hash(filter, _bloom_hash_key(key, key_len));
+}
+
+void bloom_add_hash(BloomFilter *filter, uint64_t hash) {
+	uint64_t h = _bloom_mix(hash);
+	// the high half picks the block, the low half and a second mix pick bits inside it
+	uint64_t *block = filter->blocks + (((h >> 32) * (uint64_t)filter->block_count) >> 32) * BLOOM_BLOCK_WORDS;
+	uint32_t bit = (uint32_t)h;
+	uint32_t step = (uint32_t)(_bloom_mix(h) >> 32) | 1;
+	for (int i = 0; i < filter->hash_count; i++) {
+		uint32_t pos = bit % BLOOM_BLOCK_BITS;
+		BLOOM_STORE(&block[pos / 64], BLOOM_LOAD(&block[pos / 64]) | ((uint64_t)1 << (pos % 64)));
+		bit += step;
+	}
+	filter->count++;
+}
+
+bool bloom_maybe_contains_hash(BloomFilter *filter, uint64_t hash) {
+	uint64_t h = _bloom_mix(hash);
+	uint64_t *block = filter->blocks + (((h >> 32) * (uint64_t)filter->block_count) >> 32) * BLOOM_BLOCK_WORDS;
+	uint32_t bit = (uint32_t)h;
+	uint32_t step = (uint32_t)(_bloom_mix(h) >> 32) | 1;
+	for (int i = 0; i < filter->hash_count; i++) {
+		uint32_t pos = bit % BLOOM_BLOCK_BITS;
+		if (!(BLOOM_LOAD(&block[pos / 64]) & ((uint64_t)1 << (pos % 64)))) {
+			return false;
+		}
+		bit += step;
+	}
+	return true;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// murmur3's 64 bit finalizer. spreads every input bit over the whole result
+static uint64_t _bloom_mix(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+// 64 bit FNV-1a
+static uint64_t _bloom_hash_key(unsigned char *key, int key_len) {
+	uint64_t h = 14695981039346656037ull;
+	for (int i = 0; i < key_len; i++) {
+		h ^= key[i];
+		h *= 1099511628211ull;
+	}
+	return h;
+}
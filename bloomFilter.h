@@ -0,0 +1,104 @@
+//---------------------------------------------------------
+// file:    bloomFilter.h
+// author:  Jordan Hoffmann
+// brief:   Library for blocked bloom filters, a fast check for keys that
+//          are definitely not in a set
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// bits in one block. every key's bits are set inside a single block, which is one cache line
+#define BLOOM_BLOCK_BITS 512
+
+// most bits set per key
+#define BLOOM_MAX_HASHES 16
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+typedef struct {
+	int capacity;			// number of keys the filter was sized for
+	int count;				// number of keys added since it was created or cleared
+	int block_count;		// number of BLOOM_BLOCK_BITS bit blocks
+	int hash_count;			// bits set for every key
+	double fp_rate;			// false positive rate the filter was sized for
+	uint64_t *blocks;		// block_count blocks of BLOOM_BLOCK_BITS / 64 words, cache line aligned
+	void *memory;			// allocation blocks lives in
+} BloomFilter;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		Allocates and initializes a new BloomFilter ptr
+* @details		a bloom filter answers "is this key in the set" with either "definitely not"
+*				or "maybe". it can never forget a key, so keys can't be removed, only cleared.
+*				every key lives in one 64 byte block, so a check reads a single cache line.
+*				the cost is a slightly higher false positive rate than a plain bloom filter.
+*				one thread can add keys while others check them.
+*
+* @param[in]	capacity - the number of keys you expect to add
+* @param[in]	fp_rate	 - how often a key that was never added should get "maybe". i.e 0.01
+* @return		a pointer to a newly allocated and empty filter
+*/
+BloomFilter *bloom_create(int capacity, double fp_rate);
+
+/**
+* @brief		frees a bloom filter
+*
+* @param[in]	filter - the filter to free
+*/
+void bloom_free(BloomFilter *filter);
+
+/**
+* @brief		removes every key from a bloom filter
+*
+* @param[in]	filter - the filter to clear
+*/
+void bloom_clear(BloomFilter *filter);
+
+/**
+* @brief		adds a key to a bloom filter
+*
+* @param[in]	filter  - the filter to add to
+* @param[in]	key	    - the key bytes
+* @param[in]	key_len - the number of bytes in key
+*/
+void bloom_add(BloomFilter *filter, unsigned char *key, int key_len);
+
+/**
+* @brief		checks weather a key might have been added to a bloom filter
+*
+* @param[in]	filter  - the filter to check
+* @param[in]	key	    - the key bytes
+* @param[in]	key_len - the number of bytes in key
+* @return		0 if the key was definitely never added, 1 if it might have been
+*/
+bool bloom_maybe_contains(BloomFilter *filter, unsigned char *key, int key_len);
+
+/**
+* @brief		adds a key that has already been hashed
+* @details		use this when you already have a hash of the key, i.e from a hash table.
+*				the hash is mixed again, so a 32 bit hash works as well as a 64 bit one.
+*
+* @param[in]	filter - the filter to add to
+* @param[in]	hash   - the key's hash
+*/
+void bloom_add_hash(BloomFilter *filter, uint64_t hash);
+
+/**
+* @brief		checks weather a key with this hash might have been added
+*
+* @param[in]	filter - the filter to check
+* @param[in]	hash   - the key's hash, the same one given to bloom_add_hash
+* @return		0 if the key was definitely never added, 1 if it might have been
+*/
+bool bloom_maybe_contains_hash(BloomFilter *filter, uint64_t hash);
@@ -0,0 +1,337 @@
+//---------------------------------------------------------
+// file:    concurrentHash.c
+// author:  Jordan Hoffmann
+// brief:   Library for generic type hash tables shared between threads
+//---------------------------------------------------------
+
+#include "concurrentHash.h"
+#include "epoch.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <assert.h>
+#include <stdatomic.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+#define CACHE_LINE 64
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+typedef struct _CHashNode {
+	_Atomic(struct _CHashNode *) next;	// next node in the bucket
+	unsigned hash;						// full hash of key
+	int key_len;						// number of bytes in key
+	unsigned char *key;					// copy of the key, stored after the value
+	_Alignas(max_align_t) unsigned char data[];	// value_size bytes of value, then the key
+} _CHashNode;
+
+typedef struct {
+	int size;							// number of buckets (power of 2, at least CHASH_STRIPES)
+	_Atomic(_CHashNode *) buckets[];	// heads of each bucket
+} _CHashTable;
+
+typedef struct {
+	_Alignas(CACHE_LINE) atomic_flag lock;
+} _CHashStripe;
+
+struct ConcurrentHash {
+	_Atomic(_CHashTable *) table;		// current bucket array
+	atomic_int count;					// number of elements stored
+	int value_size;						// bytes in every value
+	unsigned(*hash_func)(unsigned char *, int);	// function used to hash keys
+	Epoch *epoch;						// keeps unlinked nodes and arrays alive for readers
+	_CHashStripe stripes[CHASH_STRIPES];
+};
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static unsigned default_hash(unsigned char *key, int key_len);
+static _CHashTable *_chash_table_create(int size);
+static _CHashNode *_chash_node_create(ConcurrentHash *map, unsigned hash, unsigned char *key, int key_len, void *val);
+static void _chash_lock(atomic_flag *lock);
+static void _chash_unlock(atomic_flag *lock);
+static _CHashNode *_chash_lookup(_CHashTable *table, unsigned hash, unsigned char *key, int key_len);
+static void _chash_reclaim_node(void *node, void(free_func)(void *));
+static void _chash_reclaim_table(void *table, void(free_func)(void *));
+static void _chash_resize(ConcurrentHash *map, int old_size);
+static void _chash_unlock_all(ConcurrentHash *map);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+ConcurrentHash *chash_create(unsigned(hash_func)(unsigned char *, int), int value_size) {
+	assert(value_size >= 0);
+	ConcurrentHash *map = malloc(sizeof(ConcurrentHash));
+	if (!map) {
+		printf("failed to allocate concurrent hash table");
+		return NULL;
+	}
+	map->hash_func = hash_func ? hash_func : default_hash;
+	map->value_size = value_size;
+	atomic_init(&map->count, 0);
+	map->epoch = epoch_create();
+	for (int i = 0; i < CHASH_STRIPES; i++) {
+		atomic_flag_clear(&map->stripes[i].lock);
+	}
+	_CHashTable *table = _chash_table_create(CHASH_STRIPES);
+	if (!map->epoch || !table) {
+		epoch_free(map->epoch);
+		free(table);
+		free(map);
+		return NULL;
+	}
+	atomic_init(&map->table, table);
+	return map;
+}
+
+void chash_free(ConcurrentHash *map, void(free_func)(void *)) {
+	if (!map) {
+		return;
+	}
+	_CHashTable *table = atomic_load(&map->table);
+	for (int i = 0; i < table->size; i++) {
+		_CHashNode *node = atomic_load_explicit(&table->buckets[i], memory_order_relaxed);
+		while (node) {
+			_CHashNode *next = atomic_load_explicit(&node->next, memory_order_relaxed);
+			if (free_func) {
+				(*free_func)(*(void **)node->data);
+			}
+			free(node);
+			node = next;
+		}
+	}
+	free(table);
+	epoch_free(map->epoch);
+	free(map);
+}
+
+void chash_put(ConcurrentHash *map, unsigned char *key, int key_len, void *val, void(free_func)(void *)) {
+	unsigned hash = (*map->hash_func)(key, key_len);
+	_CHashNode *new_node = _chash_node_create(map, hash, key, key_len, val);
+	if (!new_node) {
+		return;
+	}
+	_CHashStripe *stripe = &map->stripes[hash & (CHASH_STRIPES - 1)];
+	_CHashNode *replaced = NULL;
+
+	_chash_lock(&stripe->lock);
+	// the table can only be swapped by a thread holding every stripe, so it's stable here
+	_CHashTable *table = atomic_load_explicit(&map->table, memory_order_relaxed);
+	_Atomic(_CHashNode *) *link = &table->buckets[hash & (table->size - 1)];
+	_CHashNode *node = atomic_load_explicit(link, memory_order_relaxed);
+	while (node) {
+		if (node->hash == hash && node->key_len == key_len && memcmp(node->key, key, key_len) == 0) {
+			replaced = node;
+			break;
+		}
+		link = &node->next;
+		node = atomic_load_explicit(link, memory_order_relaxed);
+	}
+	if (replaced) {
+		atomic_store_explicit(&new_node->next, atomic_load_explicit(&replaced->next, memory_order_relaxed), memory_order_relaxed);
+	}
+	else {
+		link = &table->buckets[hash & (table->size - 1)];
+		atomic_store_explicit(&new_node->next, atomic_load_explicit(link, memory_order_relaxed), memory_order_relaxed);
+	}
+	// publishing the fully built node is what makes it visible to readers
+	atomic_store_explicit(link, new_node, memory_order_release);
+	int table_size = table->size;
+	_chash_unlock(&stripe->lock);
+
+	if (replaced) {
+		epoch_retire(map->epoch, replaced, _chash_reclaim_node, free_func);
+	}
+	else if (atomic_fetch_add(&map->count, 1) + 1 > table_size / 4 * 3) {
+		_chash_resize(map, table_size);
+	}
+}
+
+bool chash_get(ConcurrentHash *map, unsigned char *key, int key_len, void *out) {
+	unsigned hash = (*map->hash_func)(key, key_len);
+	EpochReader reader = epoch_enter(map->epoch);
+	_CHashNode *node = _chash_lookup(atomic_load_explicit(&map->table, memory_order_acquire), hash, key, key_len);
+	if (node && out) {
+		memcpy(out, node->data, map->value_size);
+	}
+	epoch_exit(map->epoch, reader);
+	return node != NULL;
+}
+
+bool chash_exists(ConcurrentHash *map, unsigned char *key, int key_len) {
+	return chash_get(map, key, key_len, NULL);
+}
+
+bool chash_rem(ConcurrentHash *map, unsigned char *key, int key_len, void(free_func)(void *)) {
+	unsigned hash = (*map->hash_func)(key, key_len);
+	_CHashStripe *stripe = &map->stripes[hash & (CHASH_STRIPES - 1)];
+	_CHashNode *removed = NULL;
+
+	_chash_lock(&stripe->lock);
+	_CHashTable *table = atomic_load_explicit(&map->table, memory_order_relaxed);
+	_Atomic(_CHashNode *) *link = &table->buckets[hash & (table->size - 1)];
+	_CHashNode *node = atomic_load_explicit(link, memory_order_relaxed);
+	while (node) {
+		if (node->hash == hash && node->key_len == key_len && memcmp(node->key, key, key_len) == 0) {
+			removed = node;
+			// readers standing on the node can still follow its next pointer
+			atomic_store_explicit(link, atomic_load_explicit(&node->next, memory_order_relaxed), memory_order_release);
+			break;
+		}
+		link = &node->next;
+		node = atomic_load_explicit(link, memory_order_relaxed);
+	}
+	_chash_unlock(&stripe->lock);
+
+	if (removed) {
+		atomic_fetch_sub(&map->count, 1);
+		epoch_retire(map->epoch, removed, _chash_reclaim_node, free_func);
+	}
+	return removed != NULL;
+}
+
+int chash_count(ConcurrentHash *map) {
+	return map ? atomic_load(&map->count) : 0;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// FNV-1a. the stripe and bucket both come from the low bits, so they need to be well mixed
+static unsigned default_hash(unsigned char *key, int key_len) {
+	unsigned h = 2166136261u;
+	for (int i = 0; i < key_len; i++) {
+		h ^= key[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static _CHashTable *_chash_table_create(int size) {
+	_CHashTable *table = malloc(sizeof(_CHashTable) + size * sizeof(_Atomic(_CHashNode *)));
+	if (!table) {
+		printf("failed to allocate concurrent hash table buckets");
+		return NULL;
+	}
+	table->size = size;
+	for (int i = 0; i < size; i++) {
+		atomic_init(&table->buckets[i], NULL);
+	}
+	return table;
+}
+
+static _CHashNode *_chash_node_create(ConcurrentHash *map, unsigned hash, unsigned char *key, int key_len, void *val) {
+	_CHashNode *node = malloc(sizeof(_CHashNode) + map->value_size + key_len);
+	if (!node) {
+		printf("failed to allocate concurrent hash table node");
+		return NULL;
+	}
+	atomic_init(&node->next, NULL);
+	node->hash = hash;
+	node->key_len = key_len;
+	node->key = node->data + map->value_size;
+	memcpy(node->data, val, map->value_size);
+	memcpy(node->key, key, key_len);
+	return node;
+}
+
+static void _chash_lock(atomic_flag *lock) {
+	while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) {
+	}
+}
+
+static void _chash_unlock(atomic_flag *lock) {
+	atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+static _CHashNode *_chash_lookup(_CHashTable *table, unsigned hash, unsigned char *key, int key_len) {
+	_CHashNode *node = atomic_load_explicit(&table->buckets[hash & (table->size - 1)], memory_order_acquire);
+	while (node) {
+		if (node->hash == hash && node->key_len == key_len && memcmp(node->key, key, key_len) == 0) {
+			return node;
+		}
+		node = atomic_load_explicit(&node->next, memory_order_acquire);
+	}
+	return NULL;
+}
+
+// frees a node unlinked from the table, and its value with free_func
+static void _chash_reclaim_node(void *node, void(free_func)(void *)) {
+	if (free_func) {
+		(*free_func)(*(void **)((_CHashNode *)node)->data);
+	}
+	free(node);
+}
+
+// frees a replaced bucket array along with its nodes
+static void _chash_reclaim_table(void *table, void(free_func)(void *)) {
+	(void)free_func;
+	_CHashTable *old_table = table;
+	for (int i = 0; i < old_table->size; i++) {
+		_CHashNode *node = atomic_load_explicit(&old_table->buckets[i], memory_order_relaxed);
+		while (node) {
+			_CHashNode *next_node = atomic_load_explicit(&node->next, memory_order_relaxed);
+			free(node);
+			node = next_node;
+		}
+	}
+	free(old_table);
+}
+
+// doubles the table. writers are held off by taking every stripe, while readers keep
+// walking the old buckets, which are copied rather than relinked so they stay intact
+static void _chash_resize(ConcurrentHash *map, int old_size) {
+	for (int i = 0; i < CHASH_STRIPES; i++) {
+		_chash_lock(&map->stripes[i].lock);
+	}
+	_CHashTable *old_table = atomic_load_explicit(&map->table, memory_order_relaxed);
+	if (old_table->size != old_size) {
+		// someone else already grew it
+		_chash_unlock_all(map);
+		return;
+	}
+
+	_CHashTable *new_table = _chash_table_create(old_table->size * 2);
+	if (!new_table) {
+		// the old table still works, just with longer chains
+		_chash_unlock_all(map);
+		return;
+	}
+	for (int i = 0; i < old_table->size; i++) {
+		_CHashNode *node = atomic_load_explicit(&old_table->buckets[i], memory_order_relaxed);
+		while (node) {
+			_CHashNode *copy = _chash_node_create(map, node->hash, node->key, node->key_len, node->data);
+			if (!copy) {
+				// nobody has seen the new table, so it and the copies made so far go right away
+				_chash_reclaim_table(new_table, NULL);
+				_chash_unlock_all(map);
+				return;
+			}
+			_Atomic(_CHashNode *) *bucket = &new_table->buckets[node->hash & (new_table->size - 1)];
+			atomic_store_explicit(&copy->next, atomic_load_explicit(bucket, memory_order_relaxed), memory_order_relaxed);
+			atomic_store_explicit(bucket, copy, memory_order_relaxed);
+			node = atomic_load_explicit(&node->next, memory_order_relaxed);
+		}
+	}
+	atomic_store_explicit(&map->table, new_table, memory_order_release);
+	_chash_unlock_all(map);
+
+	// the values were copied, so the old nodes go with their array and skip free_func
+	epoch_retire(map->epoch, old_table, _chash_reclaim_table, NULL);
+	epoch_synchronize(map->epoch);
+}
+
+// releases every stripe taken by _chash_resize
+static void _chash_unlock_all(ConcurrentHash *map) {
+	for (int i = CHASH_STRIPES - 1; i >= 0; i--) {
+		_chash_unlock(&map->stripes[i].lock);
+	}
+}
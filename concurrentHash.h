@@ -0,0 +1,134 @@
+//---------------------------------------------------------
+// file:    concurrentHash.h
+// author:  Jordan Hoffmann
+// brief:   Library for generic type hash tables shared between threads
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+#include <string.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// number of writer locks. keys are spread across them by hash
+#define CHASH_STRIPES 64
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+// the layout lives in concurrentHash.c so that only it has to deal with atomics
+typedef struct ConcurrentHash ConcurrentHash;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		Allocates and initializes a new ConcurrentHash ptr
+* @details		a ConcurrentHash can be used from many threads at once without any outside locking.
+*				writers lock one of CHASH_STRIPES stripes, readers never lock or wait.
+*				growing copies the table while readers keep using the old one, and memory
+*				readers might still be looking at is only freed once they have all moved on
+*				(see epoch.h).
+*				keys are copied into the table and values are stored inline.
+*
+* @param[in]	hash_func  - function that takes a key and its length and returns a "unique"
+*				unsigned int, or NULL for a default hashing function.
+* @param[in]	value_size - the size of every value stored. i.e sizeof(int)
+* @return		a pointer to a newly allocated and empty concurrent hash table, or NULL if it
+*				couldn't be allocated
+*/
+ConcurrentHash *chash_create(unsigned(hash_func)(unsigned char *, int), int value_size);
+
+/**
+* @brief		frees a concurrent hash table and all of its contents
+* @details		no other thread may be using the table when it is freed.
+*				leave free_func NULL if the contents are not pointers or you wish to not free them.
+*
+* @param[in]	map		  - the table to free
+* @param[in]	free_func - function to call on every element in the table
+*/
+void chash_free(ConcurrentHash *map, void(free_func)(void *));
+
+/**
+* @brief		adds a value, replacing the value already stored under the key if there is one
+* @details		readers see either the old value or the new one, never a mix of both.
+*				the replaced value is passed to free_func once no reader can still see it.
+*				if the new node can't be allocated nothing changes, and if a bigger table
+*				can't be the table stays at its current size.
+*
+* @param[in]	map		  - the table to add to
+* @param[in]	key		  - the key bytes (copied)
+* @param[in]	key_len	  - the number of bytes in key
+* @param[in]	val		  - pointer to the value to copy in (value_size bytes)
+* @param[in]	free_func - function to call on a value this replaces (or NULL)
+*/
+void chash_put(ConcurrentHash *map, unsigned char *key, int key_len, void *val, void(free_func)(void *));
+
+/**
+* @brief		copies the value stored under a key
+*
+* @param[in]	map		- the table to search
+* @param[in]	key		- the key bytes to search for
+* @param[in]	key_len	- the number of bytes in key
+* @param[out]	out		- receives a copy of the value (value_size bytes). may be NULL
+* @return		1 if the key was found, 0 if it was not.
+*/
+bool chash_get(ConcurrentHash *map, unsigned char *key, int key_len, void *out);
+
+/**
+* @brief		boolian function used to determine weather a key is in the table
+*
+* @param[in]	map		- the table to search
+* @param[in]	key		- the key bytes to search for
+* @param[in]	key_len	- the number of bytes in key
+* @return		1 if the key is found, 0 if it was not.
+*/
+bool chash_exists(ConcurrentHash *map, unsigned char *key, int key_len);
+
+/**
+* @brief		removes the value stored under a key
+* @details		the value is passed to free_func once no reader can still see it.
+*
+* @param[in]	map		  - the table to remove from
+* @param[in]	key		  - the key bytes to search for
+* @param[in]	key_len	  - the number of bytes in key
+* @param[in]	free_func - function to call on the removed value (or NULL)
+* @return		1 if the key was removed, 0 if it wasn't in the table.
+*/
+bool chash_rem(ConcurrentHash *map, unsigned char *key, int key_len, void(free_func)(void *));
+
+/**
+* @brief		returns the number of elements in a concurrent hash table
+*
+* @param[in]	map - the table you're querying the size of
+* @return		the number of keys stored
+*/
+int chash_count(ConcurrentHash *map);
+
+/**
+* @brief		adds an item to a concurrent hash table under a string key
+*
+* @param[in]	type_t	   - the type of data being added. must match value_size
+* @param[in]	map		   - the table to add to
+* @param[in]	val		   - the actual data you would like to add
+* @param[in]	key_string - a unique lookup string for accessing your data later
+*/
+#define CHASH_ADD(type_t, map, val, key_string)												\
+	do {																					\
+		type_t _chash_val = val;															\
+		chash_put(map, key_string, (int)strlen((char *)(key_string)), &_chash_val, NULL);	\
+	} while (0)
+
+/**
+* @brief		copies the item stored under a string key into out
+*
+* @param[in]	map		   - the table to retrieve from
+* @param[in]	key_string - the lookup string you inserted your item with.
+* @param[out]	out		   - variable that receives the item
+* @return		1 if the key was found, 0 if it was not.
+*/
+#define CHASH_FIND(map, key_string, out) chash_get(map, key_string, (int)strlen((char *)(key_string)), &(out))
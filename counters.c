@@ -0,0 +1,293 @@
+//---------------------------------------------------------
+// file:    counters.c
+// author:  Jordan Hoffmann
+// brief:   Library for counting the allocations and operations of every
+//          DynArr, LinkedList and HashTable, with a registry to read them from
+//---------------------------------------------------------
+
+#include "counters.h"
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+#if !defined(DS_ENABLE_COUNTERS)
+// the library still builds the registry without counting, it just never has anything in it
+#define __COUNTERS_LOAD(ptr) (*(ptr))
+#define __COUNTERS_STORE(ptr, val) (*(ptr) = (val))
+#define __COUNTERS_BUMP(ptr, n) (*(ptr) += (n))
+#endif
+
+// every counted allocation starts with its size, padded so the memory after it stays aligned
+#define COUNTERS_HEADER ALLOC_ALIGN
+
+static const char *op_names[COUNTERS_OP_COUNT] = { "add", "find", "remove", "replace", "copy" };
+
+//---------------------------------------------------------
+// Private Variables:
+//---------------------------------------------------------
+
+static mtx_t registry_lock;
+static once_flag registry_once = ONCE_FLAG_INIT;
+static Counters *registry = NULL;		// newest first
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static void _registry_init(void);
+static void *_counters_alloc(void *ctx, size_t size);
+static void *_counters_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size);
+static void _counters_free(void *ctx, void *ptr);
+static void _counters_grew(Counters *counters, long long bytes);
+static void _counters_add(Counters *counters, void *ctx);
+static void _counters_unref(Counters *counters);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+Counters *counters_create(const char *kind, Allocator *allocator) {
+	if (allocator && allocator->alloc == _counters_alloc) {
+		return NULL;
+	}
+	Counters *counters = calloc(1, sizeof(Counters));
+	if (!counters) {
+		printf("failed to allocate counters");
+		return NULL;
+	}
+	counters->allocator.alloc = _counters_alloc;
+	counters->allocator.realloc = _counters_realloc;
+	counters->allocator.free = _counters_free;
+	counters->allocator.ctx = counters;
+	// a region stays a region, so freeing a container on one can still skip its nodes
+	counters->allocator.flags = allocator ? allocator->flags : ALLOC_DEFAULT;
+	counters->parent = allocator;
+	counters->kind = kind;
+	counters->refs = 1;
+
+	call_once(&registry_once, _registry_init);
+	mtx_lock(&registry_lock);
+	counters->next = registry;
+	if (registry) {
+		registry->prev = counters;
+	}
+	registry = counters;
+	mtx_unlock(&registry_lock);
+	return counters;
+}
+
+void counters_free(Counters *counters) {
+	if (counters) {
+		_counters_unref(counters);
+	}
+}
+
+void counters_set_name(Counters *counters, const char *name) {
+	if (!counters) {
+		return;
+	}
+	mtx_lock(&registry_lock);
+	strncpy(counters->name, name, COUNTERS_NAME_SIZE - 1);
+	counters->name[COUNTERS_NAME_SIZE - 1] = '\0';
+	mtx_unlock(&registry_lock);
+}
+
+void counters_reset(Counters *counters) {
+	if (!counters) {
+		return;
+	}
+	__COUNTERS_STORE(&counters->mallocs, 0);
+	__COUNTERS_STORE(&counters->reallocs, 0);
+	__COUNTERS_STORE(&counters->frees, 0);
+	__COUNTERS_STORE(&counters->bytes_peak, __COUNTERS_LOAD(&counters->bytes_live));
+	__COUNTERS_STORE(&counters->resizes, 0);
+	for (int i = 0; i < COUNTERS_OP_COUNT; i++) {
+		__COUNTERS_STORE(&counters->ops[i], 0);
+	}
+}
+
+void counters_read(Counters *counters, Counters *out) {
+	out->allocator = counters->allocator;
+	out->parent = counters->parent;
+	out->kind = counters->kind;
+	memcpy(out->name, counters->name, COUNTERS_NAME_SIZE);
+	out->mallocs = __COUNTERS_LOAD(&counters->mallocs);
+	out->reallocs = __COUNTERS_LOAD(&counters->reallocs);
+	out->frees = __COUNTERS_LOAD(&counters->frees);
+	out->bytes_live = __COUNTERS_LOAD(&counters->bytes_live);
+	out->bytes_peak = __COUNTERS_LOAD(&counters->bytes_peak);
+	out->resizes = __COUNTERS_LOAD(&counters->resizes);
+	for (int i = 0; i < COUNTERS_OP_COUNT; i++) {
+		out->ops[i] = __COUNTERS_LOAD(&counters->ops[i]);
+	}
+	out->refs = counters->refs;
+	out->prev = NULL;
+	out->next = NULL;
+}
+
+int counters_foreach(void(visit)(Counters *, void *), void *ctx) {
+	int visited = 0;
+	call_once(&registry_once, _registry_init);
+	mtx_lock(&registry_lock);
+	for (Counters *counters = registry; counters; counters = counters->next) {
+		Counters copy;
+		counters_read(counters, &copy);
+		(*visit)(&copy, ctx);
+		visited++;
+	}
+	mtx_unlock(&registry_lock);
+	return visited;
+}
+
+void counters_total(Counters *out) {
+	memset(out, 0, sizeof(Counters));
+	out->kind = "total";
+	counters_foreach(_counters_add, out);
+}
+
+void counters_reset_all(void) {
+	call_once(&registry_once, _registry_init);
+	mtx_lock(&registry_lock);
+	for (Counters *counters = registry; counters; counters = counters->next) {
+		counters_reset(counters);
+	}
+	mtx_unlock(&registry_lock);
+}
+
+void counters_dump_json(FILE *out) {
+	Counters copy;
+	bool first = true;
+	call_once(&registry_once, _registry_init);
+	fprintf(out, "[");
+	mtx_lock(&registry_lock);
+	for (Counters *counters = registry; counters; counters = counters->next) {
+		counters_read(counters, &copy);
+		fprintf(out, "%s\n  {\"kind\": \"%s\", \"name\": \"%s\", ", first ? "" : ",", copy.kind, copy.name);
+		fprintf(out, "\"mallocs\": %lld, \"reallocs\": %lld, \"frees\": %lld, ", copy.mallocs, copy.reallocs, copy.frees);
+		fprintf(out, "\"bytes_live\": %lld, \"bytes_peak\": %lld, \"resizes\": %lld, \"ops\": {",
+			copy.bytes_live, copy.bytes_peak, copy.resizes);
+		for (int i = 0; i < COUNTERS_OP_COUNT; i++) {
+			fprintf(out, "%s\"%s\": %lld", i ? ", " : "", op_names[i], copy.ops[i]);
+		}
+		fprintf(out, "}}");
+		first = false;
+	}
+	mtx_unlock(&registry_lock);
+	fprintf(out, "%s]\n", first ? "" : "\n");
+}
+
+Allocator *counters_unwrap(Allocator *allocator) {
+	if (allocator && allocator->alloc == _counters_alloc) {
+		return ((Counters *)allocator->ctx)->parent;
+	}
+	return allocator;
+}
+
+void counters_hold(Allocator *allocator) {
+	if (allocator && allocator->alloc == _counters_alloc) {
+		mtx_lock(&registry_lock);
+		((Counters *)allocator->ctx)->refs++;
+		mtx_unlock(&registry_lock);
+	}
+}
+
+void counters_release(Allocator *allocator) {
+	if (allocator && allocator->alloc == _counters_alloc) {
+		_counters_unref(allocator->ctx);
+	}
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+static void _registry_init(void) {
+	mtx_init(&registry_lock, mtx_plain);
+}
+
+static void *_counters_alloc(void *ctx, size_t size) {
+	Counters *counters = ctx;
+	unsigned char *block = alloc_malloc(counters->parent, size + COUNTERS_HEADER);
+	if (!block) {
+		return NULL;
+	}
+	*(size_t *)block = size;
+	__COUNTERS_BUMP(&counters->mallocs, 1);
+	_counters_grew(counters, (long long)size);
+	return block + COUNTERS_HEADER;
+}
+
+static void *_counters_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+	(void)old_size;
+	Counters *counters = ctx;
+	if (!ptr) {
+		return _counters_alloc(ctx, new_size);
+	}
+	unsigned char *block = (unsigned char *)ptr - COUNTERS_HEADER;
+	// the size in the header is the one that was really allocated, old_size is only the caller's idea of it
+	size_t size = *(size_t *)block;
+	block = alloc_realloc(counters->parent, block, size + COUNTERS_HEADER, new_size + COUNTERS_HEADER);
+	if (!block) {
+		return NULL;
+	}
+	*(size_t *)block = new_size;
+	__COUNTERS_BUMP(&counters->reallocs, 1);
+	_counters_grew(counters, (long long)new_size - (long long)size);
+	return block + COUNTERS_HEADER;
+}
+
+static void _counters_free(void *ctx, void *ptr) {
+	Counters *counters = ctx;
+	unsigned char *block = (unsigned char *)ptr - COUNTERS_HEADER;
+	size_t size = *(size_t *)block;
+	alloc_free(counters->parent, block);
+	__COUNTERS_BUMP(&counters->frees, 1);
+	__COUNTERS_BUMP(&counters->bytes_live, -(long long)size);
+}
+
+// adds bytes (which may be negative) to bytes_live, raising bytes_peak with it
+static void _counters_grew(Counters *counters, long long bytes) {
+	long long live = __COUNTERS_LOAD(&counters->bytes_live) + bytes;
+	__COUNTERS_STORE(&counters->bytes_live, live);
+	if (live > __COUNTERS_LOAD(&counters->bytes_peak)) {
+		__COUNTERS_STORE(&counters->bytes_peak, live);
+	}
+}
+
+// drops a reference, taking the counters out of the registry and freeing them with the last one
+static void _counters_unref(Counters *counters) {
+	mtx_lock(&registry_lock);
+	bool last = --counters->refs == 0;
+	if (last) {
+		if (counters->prev) {
+			counters->prev->next = counters->next;
+		}
+		else {
+			registry = counters->next;
+		}
+		if (counters->next) {
+			counters->next->prev = counters->prev;
+		}
+	}
+	mtx_unlock(&registry_lock);
+	if (last) {
+		free(counters);
+	}
+}
+
+// counters_foreach visitor for counters_total
+static void _counters_add(Counters *counters, void *ctx) {
+	Counters *total = ctx;
+	total->mallocs += counters->mallocs;
+	total->reallocs += counters->reallocs;
+	total->frees += counters->frees;
+	total->bytes_live += counters->bytes_live;
+	total->bytes_peak += counters->bytes_peak;
+	total->resizes += counters->resizes;
+	for (int i = 0; i < COUNTERS_OP_COUNT; i++) {
+		total->ops[i] += counters->ops[i];
+	}
+}
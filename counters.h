@@ -0,0 +1,207 @@
+//---------------------------------------------------------
+// file:    counters.h
+// author:  Jordan Hoffmann
+// brief:   Library for counting the allocations and operations of every
+//          DynArr, LinkedList and HashTable, with a registry to read them from
+//---------------------------------------------------------
+
+#pragma once
+#include "allocator.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// longest name (including the '\0') a container's counters can be labeled with
+#define COUNTERS_NAME_SIZE 32
+
+// the operations counted for each container
+typedef enum {
+	COUNTERS_ADD,		// pushes and adds
+	COUNTERS_FIND,		// finds and exists checks
+	COUNTERS_REMOVE,	// pops and removes
+	COUNTERS_REPLACE,	// puts and replaces of an existing element
+	COUNTERS_COPY,		// copies of the whole container
+	COUNTERS_OP_COUNT,
+} CountersOp;
+
+// counting only happens when the library is built with DS_ENABLE_COUNTERS (cmake -DDS_ENABLE_COUNTERS=ON).
+// without it the hooks below compile to nothing, containers have no counters and the registry is empty
+#if defined(DS_ENABLE_COUNTERS)
+// every counted allocation is this much bigger than asked for, to remember its size.
+// give pools sizeof(node) + COUNTERS_OVERHEAD slots or the nodes won't fit in them
+#define COUNTERS_OVERHEAD ALLOC_ALIGN
+#else
+#define COUNTERS_OVERHEAD 0
+#endif
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+typedef struct Counters {
+	Allocator allocator;			// counts every call, then hands it on to parent
+	Allocator *parent;				// the allocator the container was created with (or NULL for malloc)
+	const char *kind;				// "DynArr", "LinkedList" or "HashTable"
+	char name[COUNTERS_NAME_SIZE];	// label set with counters_set_name ("" if there isn't one)
+	long long mallocs;				// allocations made
+	long long reallocs;				// allocations resized
+	long long frees;				// allocations given back
+	long long bytes_live;			// bytes currently allocated
+	long long bytes_peak;			// most bytes allocated at once since the last reset
+	long long resizes;				// times the container's array or bucket array was resized
+	long long ops[COUNTERS_OP_COUNT];	// number of calls to each CountersOp
+	int refs;						// the container, plus memory retired to an epoch that is still to be freed
+	struct Counters *prev;			// neighbours in the registry
+	struct Counters *next;
+} Counters;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		Allocates a new Counters ptr for a container and adds it to the registry
+* @details		called by the containers' create functions, so there's rarely a reason to call it
+*				yourself. the container allocates through counters->allocator, which counts and
+*				passes everything on to allocator.
+*				containers made with another container's counting allocator (like a HashTable's
+*				buckets) are counted as part of that container, so NULL is returned for them.
+*
+* @param[in]	kind	  - the container type, i.e "HashTable"
+* @param[in]	allocator - the allocator the container was created with, or NULL for malloc
+* @return		a pointer to newly allocated, zeroed counters, or NULL
+*/
+Counters *counters_create(const char *kind, Allocator *allocator);
+
+/**
+* @brief		removes counters from the registry and frees them
+* @details		called when their container is freed. memory the container retired to an epoch
+*				can be freed after that, so the counters stay alive (and in the registry) until
+*				the last of it has been given back.
+*
+* @param[in]	counters - the counters to free (or NULL)
+*/
+void counters_free(Counters *counters);
+
+/**
+* @brief		labels a container's counters so they can be told apart in the registry
+* @details		i.e counters_set_name(COUNTERS_OF(sessions), "sessions"). longer names are cut
+*				to COUNTERS_NAME_SIZE - 1 characters.
+*
+* @param[in]	counters - the counters to label (NULL does nothing)
+* @param[in]	name	 - the label, which is copied
+*/
+void counters_set_name(Counters *counters, const char *name);
+
+/**
+* @brief		zeroes a container's counters
+* @details		bytes_live is kept, since the memory is still allocated, and bytes_peak starts again from it.
+*
+* @param[in]	counters - the counters to reset (NULL does nothing)
+*/
+void counters_reset(Counters *counters);
+
+/**
+* @brief		copies a container's counters
+* @details		safe to call while the container is being used on another thread, though counts
+*				from operations running at the same time may be missed.
+*
+* @param[in]	counters - the counters to read
+* @param[out]	out		 - where to put the copy
+*/
+void counters_read(Counters *counters, Counters *out);
+
+/**
+* @brief		calls visit with a copy of the counters of every live container
+* @details		the registry is locked while visiting, so visit must not create or free containers.
+*
+* @param[in]	visit - function given each copy and ctx
+* @param[in]	ctx	  - passed on to visit
+* @return		the number of containers visited
+*/
+int counters_foreach(void(visit)(Counters *, void *), void *ctx);
+
+/**
+* @brief		adds up the counters of every live container
+*
+* @param[out]	out - where to put the totals. kind is "total" and bytes_peak is the sum of the peaks
+*/
+void counters_total(Counters *out);
+
+/**
+* @brief		zeroes the counters of every live container (see counters_reset)
+*/
+void counters_reset_all(void);
+
+/**
+* @brief		writes the counters of every live container as a json array
+* @details		i.e [{"kind": "HashTable", "name": "sessions", "mallocs": 3, ... "ops": {"add": 2, ...}}]
+*
+* @param[in]	out - the stream to write to, i.e stdout
+*/
+void counters_dump_json(FILE *out);
+
+/**
+* @brief		returns the allocator a container was created with
+* @details		for allocators that aren't a container's counting allocator, that's the allocator itself.
+*
+* @param[in]	allocator - a container's allocator (or NULL)
+* @return		the allocator underneath
+*/
+Allocator *counters_unwrap(Allocator *allocator);
+
+/**
+* @brief		keeps the counters behind an allocator alive until a matching counters_release
+* @details		containers call this for memory retired to an epoch, so it can still be freed
+*				through their allocator once the container itself is gone. does nothing for
+*				allocators that aren't a counting allocator.
+*
+* @param[in]	allocator - a container's allocator (or NULL)
+*/
+void counters_hold(Allocator *allocator);
+
+/**
+* @brief		drops a reference taken by counters_hold, freeing the counters if it was the last one
+*
+* @param[in]	allocator - the allocator passed to counters_hold
+*/
+void counters_release(Allocator *allocator);
+
+// counters of a DynArr, LinkedList or HashTable (NULL when counting is off)
+#define COUNTERS_OF(container) ((container)->counters)
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ignore these helper macros
+
+// the hooks the containers count through. relaxed loads and stores rather than atomic adds,
+// so a counted container costs a few plain instructions per operation and readers on other
+// threads never tear a value. concurrent epoch readers can lose the odd count
+#if defined(DS_ENABLE_COUNTERS)
+#if defined(__GNUC__) || defined(__clang__)
+#define __COUNTERS_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define __COUNTERS_STORE(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELAXED)
+#else
+#define __COUNTERS_LOAD(ptr) (*(volatile long long *)(ptr))
+#define __COUNTERS_STORE(ptr, val) (*(volatile long long *)(ptr) = (val))
+#endif
+#define __COUNTERS_BUMP(ptr, n) __COUNTERS_STORE(ptr, __COUNTERS_LOAD(ptr) + (n))
+
+#define COUNTERS_CREATE(kind, allocator) counters_create(kind, allocator)
+#define COUNTERS_ALLOCATOR(counters, allocator) ((counters) ? &(counters)->allocator : (allocator))
+#define COUNTERS_FREE(counters) counters_free(counters)
+#define COUNTERS_OP(counters, op) do { if (counters) { __COUNTERS_BUMP(&(counters)->ops[op], 1); } } while (0)
+#define COUNTERS_RESIZE(counters) do { if (counters) { __COUNTERS_BUMP(&(counters)->resizes, 1); } } while (0)
+#define COUNTERS_HOLD(allocator) counters_hold(allocator)
+#define COUNTERS_RELEASE(allocator) counters_release(allocator)
+#else
+#define COUNTERS_CREATE(kind, allocator) ((Counters *)NULL)
+#define COUNTERS_ALLOCATOR(counters, allocator) (allocator)
+#define COUNTERS_FREE(counters) ((void)(counters))
+#define COUNTERS_OP(counters, op) ((void)0)
+#define COUNTERS_RESIZE(counters) ((void)0)
+#define COUNTERS_HOLD(allocator) ((void)(allocator))
+#define COUNTERS_RELEASE(allocator) ((void)(allocator))
+#endif
@@ -5,7 +5,7 @@
 //---------------------------------------------------------
 
 #pragma once
-#if _DEBUG
+#if defined(_MSC_VER) && defined(_DEBUG)
 #define _CRTDBG_MAP_ALLOC  
 #include <stdlib.h>  
 #include <crtdbg.h>
@@ -13,3 +13,15 @@
 #include "dynarr.h"
 #include "linkList.h"
 #include "hashTable.h"
+#include "intMap.h"
+#include "heap.h"
+#include "flatMap.h"
+#include "concurrentHash.h"
+#include "frozenHash.h"
+#include "orderedHash.h"
+#include "hashSet.h"
+#include "bloomFilter.h"
+#include "epoch.h"
+#include "allocator.h"
+#include "reclaimer.h"
+#include "counters.h"
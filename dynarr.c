@@ -8,32 +8,47 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <string.h>
 
 
-static void _initDynArr(dyn, cap);
+static void _initDynArr(DynArr *arr, int capacity);
 static void _dynArrSetCapacity(DynArr *arr, int newCap);
-static DynArr *dna_create_cap(int capacity);
+static DynArr *dna_create_cap(int capacity, Allocator *allocator);
+static void _dna_reclaim(void *job, void(free_func)(void *));
+
+// what dna_free_async hands to the reclaimer
+typedef struct {
+    DynArr *arr;
+    int dimensions;
+} _DnaFreeJob;
 
 DynArr *dna_create() {
-    DynArr *dyn;
-    dyn = malloc(sizeof(DynArr));
-    if (!dyn) {
-        printf("Failed to allocate memory \n");
-    }
-    _initDynArr(dyn, 2);
-    return dyn;
+    return dna_create_alloc(NULL);
+}
+
+DynArr *dna_create_alloc(Allocator *allocator) {
+    return dna_create_cap(2, allocator);
 }
 
 void dna_free(DynArr *arr, int dimensions, void(free_func)(void *)) {
 	assert(dimensions > 0);
+    if (arr && !free_func && alloc_is_region(arr->allocator)) {
+        // the region releases the cells and the array itself when it is dropped
+        for (int i = 0; dimensions > 1 && i < arr->size; i++) {
+            dna_free(DNA_GET(void *, arr, i), dimensions - 1, NULL);
+        }
+        COUNTERS_FREE(arr->counters);
+        return;
+    }
     if (arr) {
+        Counters *counters = arr->counters;
         if (dimensions == 1) {
             for (int i = 0; i < arr->size; i++) {
                 if (free_func) {
                     (*free_func)(DNA_GET(void *, arr, i));
                     DNA_GET(void *, arr, i) = NULL;
                 }
-                free(arr->data[i]);
+                alloc_free(arr->allocator, arr->data[i]);
                 arr->data[i] = NULL;
             }
         }
@@ -41,25 +56,48 @@ void dna_free(DynArr *arr, int dimensions, void(free_func)(void *)) {
             for (int i = 0; i < arr->size; i++) {
                 dna_free(DNA_GET(void *, arr, i), dimensions - 1, free_func);
                 DNA_GET(void *, arr, i) = NULL;
-                free(arr->data[i]);
+                alloc_free(arr->allocator, arr->data[i]);
                 arr->data[i] = NULL;
             }
         }
         if (arr->data != NULL) {
-            free(arr->data); /* free the space on the heap */
+            alloc_free(arr->allocator, arr->data); /* free the space on the heap */
             arr->data = NULL; /* make it point to null */
         }
         arr->size = 0;
         arr->capacity = 0;
-        free(arr);
+        alloc_free(arr->allocator, arr);
+        COUNTERS_FREE(counters);
     }
 }
 
+void dna_free_async(DynArr *arr, int dimensions, void(free_func)(void *), Reclaimer *reclaimer) {
+    assert(dimensions > 0);
+    if (!arr) {
+        return;
+    }
+    if (!free_func && alloc_is_region(arr->allocator) && dimensions == 1) {
+        // nothing gets visited on a region, so freeing now is as quick as handing it over
+        dna_free(arr, dimensions, NULL);
+        return;
+    }
+    _DnaFreeJob *job = malloc(sizeof(_DnaFreeJob));
+    if (!job) {
+        printf("failed to allocate dynamic array free job");
+        dna_free(arr, dimensions, free_func);
+        return;
+    }
+    job->arr = arr;
+    job->dimensions = dimensions;
+    reclaimer_retire(reclaimer, job, _dna_reclaim, free_func);
+}
+
 void dna_rem(DynArr *arr, int idx, void(free_func)(void *)) {
+	COUNTERS_OP(arr->counters, COUNTERS_REMOVE);
 	if (free_func) {
 		(*free_func)(*(void**)arr->data[idx]);
 	}
-	free(arr->data[idx]);
+	alloc_free(arr->allocator, arr->data[idx]);
     arr->data[idx] = NULL;
     //shift all elements after index to the left
 	for (int _jj = idx; _jj < arr->size - 1; _jj++) {
@@ -68,11 +106,12 @@ void dna_rem(DynArr *arr, int idx, void(free_func)(void *)) {
 	arr->size--;
 }
 
-dna_rem_back(DynArr *arr, void(free_func)(void *)) {
+void dna_rem_back(DynArr *arr, void(free_func)(void *)) {
+    COUNTERS_OP(arr->counters, COUNTERS_REMOVE);
     if (free_func) {
         (*free_func)(*(void**)arr->data[arr->size - 1]); // free element
     }
-    free(arr->data[arr->size - 1]); // free pointer to the element
+    alloc_free(arr->allocator, arr->data[arr->size - 1]); // free pointer to the element
     arr->data[arr->size - 1] = NULL;
     arr->size--;
 }
@@ -92,12 +131,15 @@ void dna_swap(DynArr *arr, int i, int  j) {
 
 DynArr *dna_copy(DynArr *source, void *(copy_func)(void *)) {
 	assert(source != NULL);
+    COUNTERS_OP(source->counters, COUNTERS_COPY);
+    // the copy gets counters of its own rather than allocating through the source's
+    Allocator *allocator = counters_unwrap(source->allocator);
     if (!(source->size > 0))
     {
-        return dna_create();
+        return dna_create_alloc(allocator);
     }
 
-	DynArr *output = dna_create_cap(source->capacity);
+	DynArr *output = dna_create_cap(source->capacity, allocator);
 
 	int i;
 	for (i = 0; i < source->size; i++) {
@@ -121,9 +163,11 @@ void dna_rem_after(DynArr *arr, int pos, void(free_func)(void *)) {
 }
 
 void __dna_push(DynArr *arr, void *data) {
+    COUNTERS_OP(arr->counters, COUNTERS_ADD);
     if (arr->size >= arr->capacity) {
+        COUNTERS_RESIZE(arr->counters);
         int newCap = arr->capacity * 2;
-        void **data = realloc(arr->data, sizeof(void *)*newCap);
+        void **data = alloc_realloc(arr->allocator, arr->data, sizeof(void *)*arr->capacity, sizeof(void *)*newCap);
         if (data) {
             arr->data = data;
         }
@@ -138,6 +182,7 @@ void __dna_push(DynArr *arr, void *data) {
 
 void *__dna_pop(DynArr *arr) {
 	//output = malloc(size);
+	COUNTERS_OP(arr->counters, COUNTERS_REMOVE);
 	void *output = arr->data[DNA_SIZE(arr) - 1];
 	arr->data[DNA_SIZE(arr) - 1] = NULL;
 	arr->size--;
@@ -145,27 +190,35 @@ void *__dna_pop(DynArr *arr) {
 }
 
 void __dna_put(DynArr *arr, int pos, void *newItem, void(free_func)(void *)) {
+    COUNTERS_OP(arr->counters, COUNTERS_REPLACE);
     if (free_func) {
         (*free_func)(*(void **)arr->data[pos]);
     }
+    alloc_free(arr->allocator, arr->data[pos]);
     arr->data[pos] = newItem;
 }
 
+void *__dna_alloc(DynArr *arr, size_t size) {
+    return alloc_malloc(arr->allocator, size);
+}
+
 /***********************************************************************/
 //private functions
 
 static void _initDynArr(DynArr *arr, int capacity) {
 	assert(capacity > 0);
 	assert(arr != NULL);
-	arr->data = (void **)calloc(capacity, sizeof(void *));
+	arr->data = (void **)alloc_malloc(arr->allocator, capacity * sizeof(void *));
 	assert(arr->data != NULL);
+	memset(arr->data, 0, capacity * sizeof(void *));
 	arr->size = 0;
 	arr->capacity = capacity;
 }
 
 static void _dynArrSetCapacity(DynArr *arr, int newCap) {
 	// Create a new dynamic array with new capacity
-    void **data = realloc(arr->data, sizeof(void *)*newCap);
+    COUNTERS_RESIZE(arr->counters);
+    void **data = alloc_realloc(arr->allocator, arr->data, sizeof(void *)*arr->capacity, sizeof(void *)*newCap);
     if (data) {
         arr->data = data;
     }
@@ -176,12 +229,23 @@ static void _dynArrSetCapacity(DynArr *arr, int newCap) {
 	arr->capacity = newCap;
 }
 
-static DynArr *dna_create_cap(int capacity) {
+static DynArr *dna_create_cap(int capacity, Allocator *allocator) {
     DynArr *dyn;
-    dyn = malloc(sizeof(DynArr));
+    Counters *counters = COUNTERS_CREATE("DynArr", allocator);
+    allocator = COUNTERS_ALLOCATOR(counters, allocator);
+    dyn = alloc_malloc(allocator, sizeof(DynArr));
     if (!dyn) {
         printf("Failed to allocate memory \n");
     }
+    dyn->allocator = allocator;
+    dyn->counters = counters;
     _initDynArr(dyn, capacity);
     return dyn;
-}
\ No newline at end of file
+}
+
+// frees the array of a dna_free_async job, on the reclaimer's thread
+static void _dna_reclaim(void *job, void(free_func)(void *)) {
+    _DnaFreeJob *j = job;
+    dna_free(j->arr, j->dimensions, free_func);
+    free(j);
+}
@@ -8,10 +8,15 @@
 #include "dynarr.h"
 #include <stdbool.h>
 #include "stdlib.h"
+#include "allocator.h"
+#include "reclaimer.h"
+#include "counters.h"
 
+#if defined(_MSC_VER) && defined(_DEBUG)
 #define _CRTDBG_MAP_ALLOC  
 #include <stdlib.h>  
 #include <crtdbg.h>
+#endif
 //---------------------------------------------------------
 // Private Consts:
 //---------------------------------------------------------
@@ -24,6 +29,8 @@ typedef struct {
 	void **data;	/* pointer to the data array		*/
 	int size;		/* Number of elements in the array	*/
 	int capacity;	/* capacity of the array			*/
+	Allocator *allocator;	/* where the array and elements come from (or NULL for malloc) */
+	Counters *counters;		/* allocations and operations, with DS_ENABLE_COUNTERS (or NULL) */
 } DynArr;
 
 //---------------------------------------------------------
@@ -42,10 +49,22 @@ typedef struct {
 */
 DynArr *dna_create();
 
+/**
+* @brief		Allocates and initializes a new DynArr ptr that gets its memory from an allocator
+* @details		the array, its data and every element pushed to it come from allocator,
+*				which has to outlive the array.
+*
+* @param[in]	allocator - the allocator to use, i.e arena_allocator(arena). NULL uses malloc
+* @return		a pointer to a newly allocated and empty dynamic array
+*/
+DynArr *dna_create_alloc(Allocator *allocator);
+
 /**
 * @brief		completely frees a dynamic array and its elements
 * @details		set free_func to NULL if your data is either not pointers
-*				or you wish to not free it.
+*				or you wish to not free it. on a region allocator (i.e an arena) with no
+*				free_func, elements aren't visited. inner arrays of a multidimensional
+*				array are still freed, since they may not be on the region.
 *
 * @param[in]	arr		 - the dynamic array you wish to free
 * @param[in]	dim		 - use this to free a 2D, 3D, etc dynamic array in one call.
@@ -53,6 +72,19 @@ DynArr *dna_create();
 */
 void dna_free(DynArr *arr, int dimensions, void(free_func)(void *));
 
+/**
+* @brief		frees a dynamic array and its elements on a reclaimer's thread
+* @details		returns right away (unless the reclaimer's queue is full) and dna_free runs
+*				later on the reclaimer's thread, so free_func has to be safe to call there.
+*				so does the array's allocator, if it has one that isn't a region.
+*
+* @param[in]	arr		  - the dynamic array you wish to free. don't use it after this
+* @param[in]	dim		  - use this to free a 2D, 3D, etc dynamic array in one call.
+* @param[in]	freeFunc  - function to call on all the elements you've pushed to the array
+* @param[in]	reclaimer - the reclaimer that frees the array
+*/
+void dna_free_async(DynArr *arr, int dimensions, void(free_func)(void *), Reclaimer *reclaimer);
+
 /**
 * @brief		pushes data to the back of the array
 *
@@ -62,7 +94,7 @@ void dna_free(DynArr *arr, int dimensions, void(free_func)(void *));
 */
 #define DNA_PUSH(type_t, arr, val)								\
 do {															\
-	type_t *newItem = malloc(sizeof(type_t));					\
+	type_t *newItem = (type_t *)__dna_alloc(arr, sizeof(type_t));	\
     if(newItem) {                                               \
 	    *newItem = val;											\
 	    __dna_push(arr, newItem);                               \
@@ -79,7 +111,8 @@ do {															\
 *
 * @param[in]	type_t - the type of data being popped. i.e (int), (double *), etc.
 * @param[in]	arr	   - the array you're popping from
-* @return   the data that was just popped off the stack (you will need to free this)
+* @return   the data that was just popped off the stack (you will need to free this,
+*           with alloc_free(arr->allocator, ptr) if the array has an allocator)
 */
 #define DNA_POP(type_t, arr) (*(type_t *)(__dna_pop(arr)))
 
@@ -102,7 +135,7 @@ void dna_rem(DynArr *arr, int idx, void(free_func)(void *));
 * @param[in]	arr	      - the array you're removing from
 * @param[in]	free_func - function to call on the element you wish to remove
 */
-dna_rem_back(DynArr *arr, void(free_func)(void *));
+void dna_rem_back(DynArr *arr, void(free_func)(void *));
 
 
 /**
@@ -162,7 +195,7 @@ void dna_swap(DynArr *arr, int idx, int  idx2);
 */
 #define DNA_PUT(type_t, arr, pos, val, free_func)				\
 do {															\
-	type_t *newItem = malloc(sizeof(type_t));					\
+	type_t *newItem = (type_t *)__dna_alloc(arr, sizeof(type_t));	\
 	*newItem = val;												\
 	__dna_put(arr, pos, newItem, free_func);                    \
 } while (0)
@@ -223,4 +256,5 @@ void dna_rem_after(DynArr *arr, int pos, void(free_func)(void *));
 // ignore these helper functions
     void __dna_push(DynArr *arr, void *data);
     void *__dna_pop(DynArr *arr);
-    void __dna_put(DynArr *arr, int pos, void *newItem, void(free_func)(void *));
\ No newline at end of file
+    void __dna_put(DynArr *arr, int pos, void *newItem, void(free_func)(void *));
+    void *__dna_alloc(DynArr *arr, size_t size);
\ No newline at end of file
@@ -0,0 +1,183 @@
+//---------------------------------------------------------
+// file:    epoch.c
+// author:  Jordan Hoffmann
+// brief:   Library for epoch based memory reclamation, letting readers walk
+//          shared data without locks while writers remove from it
+//---------------------------------------------------------
+
+#include "epoch.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdatomic.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+#define CACHE_LINE 64
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+// something unlinked that readers might still be looking at
+typedef struct _EpochRetired {
+	struct _EpochRetired *next;
+	void *ptr;							// memory to free
+	void(*reclaim_func)(void *, void(*)(void *));	// frees ptr (or NULL for free)
+	void(*free_func)(void *);			// passed on to reclaim_func
+} _EpochRetired;
+
+typedef struct {
+	_Alignas(CACHE_LINE) atomic_int readers[2];	// readers inside each epoch parity
+} _EpochSlot;
+
+struct Epoch {
+	atomic_uint epoch;					// flipped every time retired memory is reclaimed
+	atomic_flag retire_lock;			// guards retired and retired_count
+	atomic_flag sync_lock;				// only one thread waits for readers at a time
+	_EpochRetired *retired;				// memory waiting for readers to move on
+	int retired_count;					// length of retired
+	_EpochSlot slots[EPOCH_READER_SLOTS];
+};
+
+//---------------------------------------------------------
+// Private Variables:
+//---------------------------------------------------------
+
+static atomic_int next_reader_slot;
+static _Thread_local int reader_slot = -1;
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static void _epoch_lock(atomic_flag *lock);
+static void _epoch_unlock(atomic_flag *lock);
+static void _epoch_free_retired(_EpochRetired *list);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+Epoch *epoch_create(void) {
+	Epoch *epoch = malloc(sizeof(Epoch));
+	if (!epoch) {
+		printf("failed to allocate epoch");
+		return NULL;
+	}
+	atomic_init(&epoch->epoch, 0);
+	atomic_flag_clear(&epoch->retire_lock);
+	atomic_flag_clear(&epoch->sync_lock);
+	epoch->retired = NULL;
+	epoch->retired_count = 0;
+	for (int i = 0; i < EPOCH_READER_SLOTS; i++) {
+		atomic_init(&epoch->slots[i].readers[0], 0);
+		atomic_init(&epoch->slots[i].readers[1], 0);
+	}
+	return epoch;
+}
+
+void epoch_free(Epoch *epoch) {
+	if (epoch) {
+		_epoch_free_retired(epoch->retired);
+		free(epoch);
+	}
+}
+
+// marks the calling thread as reading in the current epoch. the epoch is checked
+// again after counting in, so a reclaimer can never miss a reader that saw old memory
+EpochReader epoch_enter(Epoch *epoch) {
+	if (reader_slot < 0) {
+		reader_slot = atomic_fetch_add(&next_reader_slot, 1) % EPOCH_READER_SLOTS;
+	}
+	_EpochSlot *slot = &epoch->slots[reader_slot];
+	for (;;) {
+		unsigned current = atomic_load(&epoch->epoch);
+		atomic_fetch_add(&slot->readers[current & 1], 1);
+		if (atomic_load(&epoch->epoch) == current) {
+			EpochReader reader = { reader_slot, (int)(current & 1) };
+			return reader;
+		}
+		atomic_fetch_sub(&slot->readers[current & 1], 1);
+	}
+}
+
+void epoch_exit(Epoch *epoch, EpochReader reader) {
+	atomic_fetch_sub_explicit(&epoch->slots[reader.slot].readers[reader.parity], 1, memory_order_release);
+}
+
+// queues memory that was just unlinked, reclaiming everything queued once enough builds up
+void epoch_retire(Epoch *epoch, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *)) {
+	_EpochRetired *retired = malloc(sizeof(_EpochRetired));
+	if (!retired) {
+		// it can't wait in the queue, so wait out its readers here and free it now
+		printf("failed to allocate epoch retire entry");
+		epoch_synchronize(epoch);
+		if (reclaim_func) {
+			(*reclaim_func)(ptr, free_func);
+		}
+		else {
+			free(ptr);
+		}
+		return;
+	}
+	retired->ptr = ptr;
+	retired->reclaim_func = reclaim_func;
+	retired->free_func = free_func;
+
+	_epoch_lock(&epoch->retire_lock);
+	retired->next = epoch->retired;
+	epoch->retired = retired;
+	bool full = ++epoch->retired_count >= EPOCH_RETIRE_LIMIT;
+	_epoch_unlock(&epoch->retire_lock);
+
+	if (full) {
+		epoch_synchronize(epoch);
+	}
+}
+
+// flips the epoch and waits for every reader of the previous one to leave, then frees
+// everything that was retired before the flip
+void epoch_synchronize(Epoch *epoch) {
+	_epoch_lock(&epoch->sync_lock);
+	_epoch_lock(&epoch->retire_lock);
+	_EpochRetired *list = epoch->retired;
+	epoch->retired = NULL;
+	epoch->retired_count = 0;
+	_epoch_unlock(&epoch->retire_lock);
+
+	unsigned parity = atomic_fetch_add(&epoch->epoch, 1) & 1;
+	for (int i = 0; i < EPOCH_READER_SLOTS; i++) {
+		while (atomic_load(&epoch->slots[i].readers[parity]) != 0) {
+		}
+	}
+	_epoch_unlock(&epoch->sync_lock);
+	_epoch_free_retired(list);
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+static void _epoch_lock(atomic_flag *lock) {
+	while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) {
+	}
+}
+
+static void _epoch_unlock(atomic_flag *lock) {
+	atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+static void _epoch_free_retired(_EpochRetired *list) {
+	while (list) {
+		_EpochRetired *next = list->next;
+		if (list->reclaim_func) {
+			(*list->reclaim_func)(list->ptr, list->free_func);
+		}
+		else {
+			free(list->ptr);
+		}
+		free(list);
+		list = next;
+	}
+}
@@ -0,0 +1,118 @@
+//---------------------------------------------------------
+// file:    epoch.h
+// author:  Jordan Hoffmann
+// brief:   Library for epoch based memory reclamation, letting readers walk
+//          shared data without locks while writers remove from it
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// number of counters readers are spread across when entering a read section
+#define EPOCH_READER_SLOTS 64
+
+// retired allocations that are held back before a writer waits for readers to move on
+#define EPOCH_RETIRE_LIMIT 256
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+// the layout lives in epoch.c so that only it has to deal with atomics
+typedef struct Epoch Epoch;
+
+// handed out by epoch_enter and given back to epoch_exit
+typedef struct {
+	int slot;				// reader counter the thread entered on
+	int parity;				// which of the slot's two counters was used
+} EpochReader;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		Allocates and initializes a new Epoch ptr
+* @details		an Epoch tracks which readers might still be looking at shared memory.
+*				readers wrap every access in epoch_enter / epoch_exit, which never lock or wait.
+*				writers unlink memory and hand it to epoch_retire instead of freeing it, and it
+*				is only freed once every reader that could have seen it has left.
+*				one Epoch can be shared by any number of containers.
+*
+* @return		a pointer to a newly allocated epoch
+*/
+Epoch *epoch_create(void);
+
+/**
+* @brief		frees an epoch, first freeing everything still waiting to be reclaimed
+* @details		no thread may be reading when it is freed.
+*
+* @param[in]	epoch - the epoch to free
+*/
+void epoch_free(Epoch *epoch);
+
+/**
+* @brief		starts a read section
+* @details		memory the reader reaches before epoch_exit won't be freed underneath it.
+*				read sections are cheap, but they hold back reclamation, so keep them short.
+*
+* @param[in]	epoch - the epoch guarding the data being read
+* @return		the reader, to pass to epoch_exit
+*/
+EpochReader epoch_enter(Epoch *epoch);
+
+/**
+* @brief		ends a read section started with epoch_enter
+*
+* @param[in]	epoch  - the epoch passed to epoch_enter
+* @param[in]	reader - what epoch_enter returned
+*/
+void epoch_exit(Epoch *epoch, EpochReader reader);
+
+/**
+* @brief		frees memory once no reader can still be looking at it
+* @details		call this after ptr has been unlinked, so new readers can't reach it.
+*				reclaim_func(ptr, free_func) is called when it is safe, or free(ptr) if
+*				reclaim_func is NULL. once EPOCH_RETIRE_LIMIT allocations are waiting (or if
+*				ptr can't be queued) this calls epoch_synchronize, so it must not be called
+*				inside a read section.
+*
+* @param[in]	epoch		 - the epoch readers of ptr use
+* @param[in]	ptr			 - the memory to free
+* @param[in]	reclaim_func - function that frees ptr (or NULL)
+* @param[in]	free_func	 - passed on to reclaim_func, i.e for freeing a value inside ptr
+*/
+void epoch_retire(Epoch *epoch, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *));
+
+/**
+* @brief		waits for every current reader to leave, then frees everything retired so far
+* @details		must not be called inside a read section.
+*
+* @param[in]	epoch - the epoch to synchronize
+*/
+void epoch_synchronize(Epoch *epoch);
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ignore these helper functions
+
+// loads and stores for pointers and ints that epoch readers look at while a writer changes them.
+// stores publish everything written before them, loads see everything published before them
+#if defined(__GNUC__) || defined(__clang__)
+#define __EPOCH_LOAD_PTR(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define __EPOCH_STORE_PTR(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+#define __EPOCH_LOAD_INT(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define __EPOCH_STORE_INT(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+#define __EPOCH_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+// msvc gives volatile accesses acquire and release semantics on x86 and x64 (/volatile:ms)
+#include <intrin.h>
+#define __EPOCH_LOAD_PTR(ptr) (*(void *volatile *)(ptr))
+#define __EPOCH_STORE_PTR(ptr, val) (*(void *volatile *)(ptr) = (val))
+#define __EPOCH_LOAD_INT(ptr) (*(volatile int *)(ptr))
+#define __EPOCH_STORE_INT(ptr, val) (*(volatile int *)(ptr) = (val))
+#define __EPOCH_FENCE() _mm_mfence()
+#endif
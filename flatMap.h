@@ -0,0 +1,280 @@
+//---------------------------------------------------------
+// file:    flatMap.h
+// author:  Jordan Hoffmann
+// brief:   Library for small sorted maps in flat arrays generated per type
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// capacity of a map the first time something is put in it (an empty map allocates nothing)
+#define FLATMAP_MIN_CAPACITY 4
+
+// values start at a multiple of this in the block they share with the keys
+#define FLATMAP_ALIGN 16
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		declares a sorted flat map type and its functions
+* @details		keys and values are stored inline in two sorted arrays that share one allocation,
+*				so a map is two allocations however many keys it holds, and a find is a binary
+*				search over a few cache lines with no pointers to chase. puts and removes shift
+*				the arrays, so this is for small maps (up to a thousand or so keys) that are read
+*				far more than they change, or are built all at once with name_build.
+*				put this in a header, and FLATMAP_DEFINE with the same arguments in one .c file.
+*
+*				generates:
+*				name   *name_create(void);
+*				name   *name_create_cap(int capacity);
+*				name   *name_build(const key_t *keys, const val_t *vals, int count);	(any order)
+*				void    name_free(name *map);
+*				void    name_put(name *map, key_t key, val_t val);	(adds or replaces)
+*				val_t  *name_find(name *map, key_t key);			(NULL if the key isn't there)
+*				bool    name_exists(name *map, key_t key);
+*				bool    name_rem(name *map, key_t key);				(false if the key isn't there)
+*				int     name_lower_bound(name *map, key_t key);		(index of the first key >= key)
+*
+* @param[in]	name  - the name of the map type, also used as the prefix of its functions
+* @param[in]	key_t - the type of the keys, i.e int or const char *
+* @param[in]	val_t - the type of the values
+*/
+#define FLATMAP_DECLARE(name, key_t, val_t)													\
+	/* so const applies to the key or value even when it's a pointer type */				\
+	typedef key_t name##_key;																\
+	typedef val_t name##_val;																\
+	typedef struct {																		\
+		int count;				/* number of keys stored					*/				\
+		int capacity;			/* number of keys there's room for			*/				\
+		key_t *keys;			/* sorted keys, at the start of the block	*/				\
+		val_t *vals;			/* vals[i] belongs to keys[i]				*/				\
+	} name;																					\
+	name *name##_create(void);																\
+	name *name##_create_cap(int capacity);													\
+	name *name##_build(const name##_key *keys, const name##_val *vals, int count);			\
+	void name##_free(name *map);															\
+	void name##_put(name *map, key_t key, val_t val);										\
+	val_t *name##_find(name *map, key_t key);												\
+	bool name##_exists(name *map, key_t key);												\
+	bool name##_rem(name *map, key_t key);													\
+	int name##_lower_bound(name *map, key_t key)
+
+/**
+* @brief		defines the functions declared by FLATMAP_DECLARE
+* @details		use exactly once per map type, in a .c file that has seen FLATMAP_DECLARE.
+*				less(a, b) is true when key a sorts before key b, and two keys are the same key
+*				when neither is less than the other. i.e #define int_less(a, b) ((a) < (b)),
+*				or #define str_less(a, b) (strcmp(a, b) < 0) for string keys, which aren't copied.
+*				it can be a macro or a function.
+*
+* @param[in]	name  - the same name given to FLATMAP_DECLARE
+* @param[in]	key_t - the same key type given to FLATMAP_DECLARE
+* @param[in]	val_t - the same value type given to FLATMAP_DECLARE
+* @param[in]	less  - the key ordering, called as less(a, b) with two key_t
+*/
+#define FLATMAP_DEFINE(name, key_t, val_t, less)												\
+	typedef struct {																		\
+		key_t key;																			\
+		val_t val;																			\
+		int index;																			\
+	} name##__pair;																			\
+	static size_t name##__vals_offset(int capacity) {										\
+		return (capacity * sizeof(key_t) + FLATMAP_ALIGN - 1) & ~(size_t)(FLATMAP_ALIGN - 1);	\
+	}																						\
+	/* points keys and vals at a new block of capacity, copying over what's there */		\
+	static bool name##__set_capacity(name *map, int capacity) {								\
+		char *block = malloc(name##__vals_offset(capacity) + capacity * sizeof(val_t));		\
+		if (!block) {																		\
+			printf("failed to allocate flat map keys");										\
+			return false;																	\
+		}																					\
+		key_t *keys = (key_t *)block;														\
+		val_t *vals = (val_t *)(block + name##__vals_offset(capacity));						\
+		if (map->count) {																	\
+			memcpy(keys, map->keys, map->count * sizeof(key_t));							\
+			memcpy(vals, map->vals, map->count * sizeof(val_t));							\
+		}																					\
+		free(map->keys);																	\
+		map->keys = keys;																	\
+		map->vals = vals;																	\
+		map->capacity = capacity;															\
+		return true;																		\
+	}																						\
+	name *name##_create_cap(int capacity) {													\
+		name *map = malloc(sizeof(name));													\
+		if (!map) {																			\
+			printf("failed to allocate flat map");											\
+			return NULL;																	\
+		}																					\
+		map->count = 0;																		\
+		map->capacity = 0;																	\
+		map->keys = NULL;																	\
+		map->vals = NULL;																	\
+		if (capacity > 0) name##__set_capacity(map, capacity);								\
+		return map;																			\
+	}																						\
+	name *name##_create(void) {																\
+		return name##_create_cap(0);														\
+	}																						\
+	void name##_free(name *map) {															\
+		if (map) {																			\
+			free(map->keys);																\
+			free(map);																		\
+		}																					\
+	}																						\
+	/* branchless: the loop always runs log2(count) times and picks a half with a cmov, */	\
+	/* so a miss costs the same as a hit and nothing is mispredicted */						\
+	int name##_lower_bound(name *map, key_t key) {											\
+		if (!map->count) return 0;															\
+		const name##_key *base = map->keys;													\
+		int n = map->count;																	\
+		while (n > 1) {																		\
+			int half = n / 2;																\
+			base = (less(base[half], key)) ? base + half : base;							\
+			n -= half;																		\
+		}																					\
+		return (int)(base - map->keys) + ((less(*base, key)) ? 1 : 0);						\
+	}																						\
+	val_t *name##_find(name *map, key_t key) {												\
+		int idx = name##_lower_bound(map, key);												\
+		if (idx == map->count || (less(key, map->keys[idx]))) return NULL;					\
+		return &map->vals[idx];																\
+	}																						\
+	bool name##_exists(name *map, key_t key) {												\
+		return name##_find(map, key) != NULL;												\
+	}																						\
+	void name##_put(name *map, key_t key, val_t val) {										\
+		int idx = name##_lower_bound(map, key);												\
+		if (idx < map->count && !(less(key, map->keys[idx]))) {								\
+			map->vals[idx] = val;															\
+			return;																			\
+		}																					\
+		if (map->count == map->capacity) {													\
+			int capacity = map->capacity ? map->capacity * 2 : FLATMAP_MIN_CAPACITY;		\
+			if (!name##__set_capacity(map, capacity)) return;								\
+		}																					\
+		memmove(map->keys + idx + 1, map->keys + idx, (map->count - idx) * sizeof(key_t));	\
+		memmove(map->vals + idx + 1, map->vals + idx, (map->count - idx) * sizeof(val_t));	\
+		map->keys[idx] = key;																\
+		map->vals[idx] = val;																\
+		map->count++;																		\
+	}																						\
+	bool name##_rem(name *map, key_t key) {													\
+		int idx = name##_lower_bound(map, key);												\
+		if (idx == map->count || (less(key, map->keys[idx]))) return false;					\
+		map->count--;																		\
+		memmove(map->keys + idx, map->keys + idx + 1, (map->count - idx) * sizeof(key_t));	\
+		memmove(map->vals + idx, map->vals + idx + 1, (map->count - idx) * sizeof(val_t));	\
+		return true;																		\
+	}																						\
+	/* orders pairs by key, then by where they were in the input so the last one wins */	\
+	static int name##__pair_cmp(const void *a, const void *b) {								\
+		const name##__pair *pa = a;															\
+		const name##__pair *pb = b;															\
+		if (less(pa->key, pb->key)) return -1;												\
+		if (less(pb->key, pa->key)) return 1;												\
+		return pa->index - pb->index;														\
+	}																						\
+	name *name##_build(const name##_key *keys, const name##_val *vals, int count) {		\
+		name *map = name##_create_cap(count);												\
+		if (!map || count <= 0) return map;													\
+		if (!map->keys) {																	\
+			name##_free(map);																\
+			return NULL;																	\
+		}																					\
+		bool sorted = true;																	\
+		for (int _ii = 1; _ii < count && sorted; _ii++) {									\
+			sorted = less(keys[_ii - 1], keys[_ii]);										\
+		}																					\
+		if (sorted) {																		\
+			/* already in order with no repeats, as when copying another map's arrays */	\
+			memcpy(map->keys, keys, count * sizeof(key_t));									\
+			memcpy(map->vals, vals, count * sizeof(val_t));									\
+			map->count = count;																\
+			return map;																		\
+		}																					\
+		name##__pair *pairs = malloc(count * sizeof(name##__pair));							\
+		if (!pairs) {																		\
+			printf("failed to allocate flat map pairs");									\
+			name##_free(map);																\
+			return NULL;																	\
+		}																					\
+		for (int _ii = 0; _ii < count; _ii++) {												\
+			pairs[_ii].key = keys[_ii];														\
+			pairs[_ii].val = vals[_ii];														\
+			pairs[_ii].index = _ii;															\
+		}																					\
+		qsort(pairs, count, sizeof(name##__pair), name##__pair_cmp);						\
+		for (int _ii = 0; _ii < count; _ii++) {												\
+			/* of a run of the same key only the last (latest in the input) is kept */		\
+			if (_ii + 1 < count && !(less(pairs[_ii].key, pairs[_ii + 1].key))) continue;	\
+			map->keys[map->count] = pairs[_ii].key;											\
+			map->vals[map->count] = pairs[_ii].val;											\
+			map->count++;																	\
+		}																					\
+		free(pairs);																		\
+		return map;																			\
+	}																						\
+	typedef int name##__defined
+
+/**
+* @brief		run code with every key and value in a flat map, in key order
+* @details		don't put or remove keys inside run.
+* @note         the variable names _ii and _ii_end can not be used with this function
+*
+* @param[in]	key_t - the key type of the map
+* @param[in]	val_t - the value type of the map
+* @param[in]	key_item - your chosen variable name for the current key
+* @param[in]	val_item - your chosen variable name for the current value
+* @param[in]	map   - the map you're itterating through
+* @param[in]	run   - the code you would like to run. this can be multiple lines long
+*/
+#define FLATMAP_FOREACH(key_t, val_t, key_item, val_item, map, run)							\
+	FLATMAP_FOREACH_RANGE(key_t, val_t, key_item, val_item, map, 0, FLATMAP_SIZE(map), run)
+
+/**
+* @brief		run code with the keys and values from index first up to (not including) end, in key order
+* @details		get the indexes with name_lower_bound, i.e every key in [lo, hi) is
+*				FLATMAP_FOREACH_RANGE(..., map, ages_lower_bound(map, lo), ages_lower_bound(map, hi), run).
+*				don't put or remove keys inside run.
+* @note         the variable names _ii and _ii_end can not be used with this function
+*
+* @param[in]	key_t - the key type of the map
+* @param[in]	val_t - the value type of the map
+* @param[in]	key_item - your chosen variable name for the current key
+* @param[in]	val_item - your chosen variable name for the current value
+* @param[in]	map   - the map you're itterating through
+* @param[in]	first - index of the first key to visit
+* @param[in]	end   - index one past the last key to visit
+* @param[in]	run   - the code you would like to run. this can be multiple lines long
+*/
+#define FLATMAP_FOREACH_RANGE(key_t, val_t, key_item, val_item, map, first, end, run)			\
+do {																						\
+	if (map) {																				\
+		for (int _ii = (first), _ii_end = (end); _ii < _ii_end; _ii++) {					\
+			key_t key_item = (map)->keys[_ii];												\
+			val_t val_item = (map)->vals[_ii];												\
+			/* run may only use one of them */												\
+			(void)key_item;																	\
+			(void)val_item;																	\
+			run;																			\
+		}																					\
+	}																						\
+} while (0)
+
+/**
+* @brief		returns the number of keys in a flat map
+*
+* @param[in]	map - the map you're querying the size of
+* @return		the number of keys stored
+*/
+#define FLATMAP_SIZE(map) ((map) ? (map)->count : 0)
@@ -0,0 +1,577 @@
+//---------------------------------------------------------
+// file:    frozenHash.c
+// author:  Jordan Hoffmann
+// brief:   Library for read only perfect hash tables built from a HashTable,
+//          and snapshots of them that can be memory mapped
+//---------------------------------------------------------
+
+#include "frozenHash.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// global seeds tried before giving up on a build
+#define FROZEN_MAX_BUILDS 16
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static uint64_t _frozen_mix(uint64_t h);
+static uint64_t _frozen_hash(unsigned char *key, int key_len, uint64_t seed);
+static uint32_t _frozen_bucket(uint64_t hash, uint32_t bucket_count);
+static uint32_t _frozen_position(uint64_t hash, uint32_t seed, uint32_t slot_range);
+static int _frozen_gather(HashTable *hash_table, _HashItem **items);
+static int _frozen_dedupe(_HashItem **items, uint64_t *hashes, int count);
+static int _frozen_compare(const void *a, const void *b);
+static bool _frozen_place(uint64_t *hashes, int count, uint32_t bucket_count, uint32_t slot_range,
+						  uint32_t *seeds, uint32_t *positions);
+static void _frozen_attach(FrozenHash *frozen, unsigned char *block);
+static bool _frozen_valid(unsigned char *block, uint64_t size);
+static bool _frozen_section(uint64_t off, uint64_t len, uint64_t end);
+static void _frozen_unmap(unsigned char *block, uint64_t size, void *map_handle);
+static uint64_t _align(uint64_t offset, uint64_t alignment);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+FrozenHash *hash_freeze(HashTable *hash_table, int value_size) {
+	assert(value_size >= 0);
+	_HashItem **items = malloc((hash_table->count + 1) * sizeof(_HashItem *));
+	if (!items) {
+		printf("failed to allocate frozen hash table items");
+		return NULL;
+	}
+	int count = _frozen_gather(hash_table, items);
+	uint32_t bucket_count = count / FROZEN_KEYS_PER_BUCKET + 1;
+	// leaving 3% of positions spare keeps the seed search short. positions past
+	// count are folded back onto the empty slots afterwards, so no slot is wasted
+	uint32_t slot_range = count + count / 32 + 1;
+
+	uint64_t *hashes = malloc((count + 1) * sizeof(uint64_t));
+	uint32_t *positions = malloc((count + 1) * sizeof(uint32_t));
+	uint32_t *seeds = malloc(bucket_count * sizeof(uint32_t));
+	if (!hashes || !positions || !seeds) {
+		printf("failed to allocate frozen hash table seeds");
+		free(items);
+		free(hashes);
+		free(positions);
+		free(seeds);
+		return NULL;
+	}
+	uint64_t seed = 0;
+	bool placed = false;
+	for (int build = 0; build < FROZEN_MAX_BUILDS && !placed; build++) {
+		seed = _frozen_mix(build + 1);
+		for (int i = 0; i < count; i++) {
+			hashes[i] = _frozen_hash(items[i]->key, items[i]->key_len, seed);
+		}
+		if (build == 0) {
+			count = _frozen_dedupe(items, hashes, count);
+			if (count < 0) {
+				break;
+			}
+			bucket_count = count / FROZEN_KEYS_PER_BUCKET + 1;
+			slot_range = count + count / 32 + 1;
+		}
+		placed = _frozen_place(hashes, count, bucket_count, slot_range, seeds, positions);
+	}
+	if (!placed) {
+		printf("failed to build frozen hash table");
+		free(items);
+		free(hashes);
+		free(positions);
+		free(seeds);
+		return NULL;
+	}
+
+	/* lay the block out */
+	uint32_t value_stride = (uint32_t)_align(value_size, 8);
+	uint64_t key_bytes = 0;
+	for (int i = 0; i < count; i++) {
+		key_bytes += items[i]->key_len + 1;
+	}
+	_FrozenHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = FROZEN_MAGIC;
+	header.version = FROZEN_VERSION;
+	header.count = count;
+	header.bucket_count = bucket_count;
+	header.slot_range = slot_range;
+	header.value_size = value_size;
+	header.value_stride = value_stride;
+	header.seed = seed;
+	header.seeds_off = _align(sizeof(_FrozenHeader), 8);
+	header.remap_off = _align(header.seeds_off + bucket_count * sizeof(uint32_t), 8);
+	header.slots_off = _align(header.remap_off + (slot_range - count) * sizeof(uint32_t), 16);
+	header.values_off = _align(header.slots_off + (uint64_t)count * sizeof(_FrozenSlot), 16);
+	header.keys_off = header.values_off + (uint64_t)count * value_stride;
+	header.total_size = _align(header.keys_off + key_bytes, 16);
+
+	unsigned char *block = calloc(1, (size_t)header.total_size);
+	if (!block) {
+		printf("failed to allocate frozen hash table");
+		free(items);
+		free(hashes);
+		free(positions);
+		free(seeds);
+		return NULL;
+	}
+	memcpy(block, &header, sizeof(header));
+	memcpy(block + header.seeds_off, seeds, bucket_count * sizeof(uint32_t));
+
+	// every position past count takes one of the slots below count nobody landed on
+	uint32_t *remap = (uint32_t *)(block + header.remap_off);
+	bool *taken = calloc(count + 1, sizeof(bool));
+	if (!taken) {
+		printf("failed to allocate frozen hash table");
+		free(block);
+		free(items);
+		free(hashes);
+		free(positions);
+		free(seeds);
+		return NULL;
+	}
+	for (int i = 0; i < count; i++) {
+		if (positions[i] < (uint32_t)count) {
+			taken[positions[i]] = true;
+		}
+	}
+	uint32_t free_slot = 0;
+	for (int i = 0; i < count; i++) {
+		if (positions[i] >= (uint32_t)count) {
+			while (taken[free_slot]) free_slot++;
+			taken[free_slot] = true;
+			remap[positions[i] - count] = free_slot;
+			positions[i] = free_slot;
+		}
+	}
+	free(taken);
+
+	_FrozenSlot *slots = (_FrozenSlot *)(block + header.slots_off);
+	uint64_t key_off = 0;
+	for (int i = 0; i < count; i++) {
+		_FrozenSlot *slot = &slots[positions[i]];
+		slot->hash = hashes[i];
+		slot->key_off = key_off;
+		slot->key_len = items[i]->key_len;
+		memcpy(block + header.keys_off + key_off, items[i]->key, items[i]->key_len);
+		key_off += items[i]->key_len + 1;
+		// a value stored shorter than value_size is only copied as far as it goes, the rest stays zero
+		int copy_size = items[i]->value_size < value_size ? items[i]->value_size : value_size;
+		memcpy(block + header.values_off + (uint64_t)positions[i] * value_stride, items[i]->data, copy_size);
+	}
+	free(items);
+	free(hashes);
+	free(positions);
+	free(seeds);
+
+	FrozenHash *frozen = malloc(sizeof(FrozenHash));
+	if (!frozen) {
+		printf("failed to allocate frozen hash table");
+		free(block);
+		return NULL;
+	}
+	_frozen_attach(frozen, block);
+	frozen->mapped = false;
+	frozen->map_handle = NULL;
+	return frozen;
+}
+
+void frozen_free(FrozenHash *frozen) {
+	if (!frozen) {
+		return;
+	}
+	if (frozen->mapped) {
+		_frozen_unmap(frozen->block, frozen->header->total_size, frozen->map_handle);
+	}
+	else {
+		free(frozen->block);
+	}
+	free(frozen);
+}
+
+bool hash_save(HashTable *hash_table, const char *path, int value_size) {
+	FrozenHash *frozen = hash_freeze(hash_table, value_size);
+	if (!frozen) {
+		return false;
+	}
+	bool saved = frozen_save(frozen, path);
+	frozen_free(frozen);
+	return saved;
+}
+
+bool frozen_save(FrozenHash *frozen, const char *path) {
+	FILE *file = fopen(path, "wb");
+	if (!file) {
+		printf("failed to open %s for writing", path);
+		return false;
+	}
+	size_t size = (size_t)frozen->header->total_size;
+	bool saved = fwrite(frozen->block, 1, size, file) == size;
+	if (fclose(file) != 0) {
+		saved = false;
+	}
+	if (!saved) {
+		printf("failed to write %s", path);
+	}
+	return saved;
+}
+
+FrozenHash *hash_map(const char *path) {
+	unsigned char *block = NULL;
+	uint64_t size = 0;
+	void *map_handle = NULL;
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		printf("failed to open %s", path);
+		return NULL;
+	}
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+		size = (uint64_t)file_size.QuadPart;
+		map_handle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (map_handle) {
+			block = MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0);
+			if (!block) {
+				CloseHandle(map_handle);
+			}
+		}
+	}
+	CloseHandle(file);
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0) {
+		printf("failed to open %s", path);
+		return NULL;
+	}
+	struct stat info;
+	if (fstat(file, &info) == 0 && info.st_size > 0) {
+		size = (uint64_t)info.st_size;
+		block = mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, file, 0);
+		if (block == MAP_FAILED) {
+			block = NULL;
+		}
+	}
+	close(file);
+#endif
+	if (!block) {
+		printf("failed to map %s", path);
+		return NULL;
+	}
+	if (!_frozen_valid(block, size)) {
+		printf("%s is not a hash table snapshot", path);
+		_frozen_unmap(block, size, map_handle);
+		return NULL;
+	}
+
+	FrozenHash *frozen = malloc(sizeof(FrozenHash));
+	if (!frozen) {
+		printf("failed to allocate frozen hash table");
+		_frozen_unmap(block, size, map_handle);
+		return NULL;
+	}
+	_frozen_attach(frozen, block);
+	frozen->mapped = true;
+	frozen->map_handle = map_handle;
+	return frozen;
+}
+
+bool frozen_exists(FrozenHash *frozen, unsigned char *key) {
+	return __frozen_find(frozen, key, (int)strlen((const char *)key)) != NULL;
+}
+
+bool frozen_exists_bin(FrozenHash *frozen, unsigned char *key, int key_len) {
+	return __frozen_find(frozen, key, key_len) != NULL;
+}
+
+void *__frozen_find(FrozenHash *frozen, unsigned char *key, int key_len) {
+	_FrozenHeader *header = frozen->header;
+	if (header->count == 0) {
+		return NULL;
+	}
+	uint64_t hash = _frozen_hash(key, key_len, header->seed);
+	uint32_t seed = frozen->seeds[_frozen_bucket(hash, header->bucket_count)];
+	uint32_t pos = _frozen_position(hash, seed, header->slot_range);
+	if (pos >= header->count) {
+		pos = frozen->remap[pos - header->count];
+		// hash_map only checks the sections, so a corrupt remap entry or key is caught here
+		if (pos >= header->count) {
+			return NULL;
+		}
+	}
+	_FrozenSlot *slot = &frozen->slots[pos];
+	uint64_t keys_size = header->total_size - header->keys_off;
+	if (slot->hash != hash || slot->key_len != (uint32_t)key_len ||
+		(uint64_t)key_len > keys_size || slot->key_off > keys_size - key_len ||
+		memcmp(frozen->keys + slot->key_off, key, key_len) != 0) {
+		return NULL;
+	}
+	return frozen->values + (uint64_t)pos * header->value_stride;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// murmur3 64 bit finalizer
+static uint64_t _frozen_mix(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+// 64 bit seeded key hash. independent of the HashTable's hash_func, which is only 32 bits
+static uint64_t _frozen_hash(unsigned char *key, int key_len, uint64_t seed) {
+	uint64_t h = seed ^ ((uint64_t)key_len * 0x9e3779b97f4a7c15ull);
+	int i = 0;
+	for (; i + 8 <= key_len; i += 8) {
+		uint64_t k;
+		memcpy(&k, key + i, 8);
+		h = (h ^ _frozen_mix(k)) * 0x9e3779b97f4a7c15ull;
+	}
+	if (i < key_len) {
+		uint64_t k = 0;
+		memcpy(&k, key + i, key_len - i);
+		h = (h ^ _frozen_mix(k)) * 0x9e3779b97f4a7c15ull;
+	}
+	return _frozen_mix(h);
+}
+
+static uint32_t _frozen_bucket(uint64_t hash, uint32_t bucket_count) {
+	return (uint32_t)(((hash >> 32) * bucket_count) >> 32);
+}
+
+static uint32_t _frozen_position(uint64_t hash, uint32_t seed, uint32_t slot_range) {
+	uint64_t h = _frozen_mix(hash ^ ((uint64_t)seed * 0x9e3779b97f4a7c15ull));
+	return (uint32_t)(((h & 0xffffffffull) * slot_range) >> 32);
+}
+
+// collects every item, in bucket order
+static int _frozen_gather(HashTable *hash_table, _HashItem **items) {
+	int count = 0;
+	int arrays = hash_table->old_buckets ? 2 : 1;
+	for (int a = 0; a < arrays; a++) {
+		LinkedList **buckets = a == 0 ? hash_table->buckets : hash_table->old_buckets;
+		int start = a == 0 ? 0 : hash_table->rehash_pos;
+		int end = a == 0 ? hash_table->table_size : hash_table->old_table_size;
+		for (int b = start; b < end; b++) {
+			for (sl_node *node = buckets[b]->head; node; node = node->next) {
+				items[count++] = node->data;
+			}
+		}
+	}
+	return count;
+}
+
+typedef struct {
+	uint64_t hash;
+	int index;
+} _FrozenSortKey;
+
+static int _frozen_compare(const void *a, const void *b) {
+	const _FrozenSortKey *x = a;
+	const _FrozenSortKey *y = b;
+	if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+	return x->index - y->index;
+}
+
+// drops every item whose key already appeared earlier, keeping the first one, which
+// is the one HASH_FIND would return. items are sorted by hash so only neighbours compare.
+// returns the number kept, or -1 if it couldn't allocate
+static int _frozen_dedupe(_HashItem **items, uint64_t *hashes, int count) {
+	_FrozenSortKey *sorted = malloc((count + 1) * sizeof(_FrozenSortKey));
+	bool *dropped = calloc(count + 1, sizeof(bool));
+	if (!sorted || !dropped) {
+		printf("failed to allocate frozen hash table");
+		free(sorted);
+		free(dropped);
+		return -1;
+	}
+	for (int i = 0; i < count; i++) {
+		sorted[i].hash = hashes[i];
+		sorted[i].index = i;
+	}
+	qsort(sorted, count, sizeof(_FrozenSortKey), _frozen_compare);
+	for (int i = 1; i < count; i++) {
+		for (int j = i - 1; j >= 0 && sorted[j].hash == sorted[i].hash; j--) {
+			_HashItem *a = items[sorted[i].index];
+			_HashItem *b = items[sorted[j].index];
+			if (!dropped[sorted[j].index] && a->key_len == b->key_len && memcmp(a->key, b->key, a->key_len) == 0) {
+				dropped[sorted[i].index] = true;
+				break;
+			}
+		}
+	}
+	int kept = 0;
+	for (int i = 0; i < count; i++) {
+		if (!dropped[i]) {
+			items[kept] = items[i];
+			hashes[kept] = hashes[i];
+			kept++;
+		}
+	}
+	free(sorted);
+	free(dropped);
+	return kept;
+}
+
+// picks a seed for every bucket, biggest buckets first, so that all keys get distinct
+// positions in [0, slot_range). returns false if some bucket has no working seed
+static bool _frozen_place(uint64_t *hashes, int count, uint32_t bucket_count, uint32_t slot_range,
+						  uint32_t *seeds, uint32_t *positions) {
+	uint32_t *bucket_start = calloc(bucket_count + 1, sizeof(uint32_t));
+	uint32_t *members = malloc((count + 1) * sizeof(uint32_t));
+	uint32_t *order = malloc(bucket_count * sizeof(uint32_t));
+	bool *taken = calloc(slot_range, sizeof(bool));
+	uint32_t *fill = malloc((bucket_count + 1) * sizeof(uint32_t));
+	if (!bucket_start || !members || !order || !taken || !fill) {
+		printf("failed to allocate frozen hash table buckets");
+		free(bucket_start);
+		free(members);
+		free(order);
+		free(taken);
+		free(fill);
+		return false;
+	}
+	bool placed = true;
+
+	/* group the keys by bucket (counting sort) */
+	for (int i = 0; i < count; i++) {
+		bucket_start[_frozen_bucket(hashes[i], bucket_count) + 1]++;
+	}
+	uint32_t max_size = 0;
+	for (uint32_t b = 0; b < bucket_count; b++) {
+		if (bucket_start[b + 1] > max_size) max_size = bucket_start[b + 1];
+		bucket_start[b + 1] += bucket_start[b];
+	}
+	memcpy(fill, bucket_start, (bucket_count + 1) * sizeof(uint32_t));
+	for (int i = 0; i < count; i++) {
+		members[fill[_frozen_bucket(hashes[i], bucket_count)]++] = i;
+	}
+	free(fill);
+
+	/* order the buckets from biggest to smallest (counting sort by size) */
+	uint32_t n = 0;
+	for (uint32_t size = max_size; size > 0; size--) {
+		for (uint32_t b = 0; b < bucket_count; b++) {
+			if (bucket_start[b + 1] - bucket_start[b] == size) order[n++] = b;
+		}
+	}
+	for (uint32_t b = 0; b < bucket_count; b++) {
+		seeds[b] = 0;
+	}
+
+	for (uint32_t o = 0; o < n && placed; o++) {
+		uint32_t b = order[o];
+		uint32_t first = bucket_start[b];
+		uint32_t last = bucket_start[b + 1];
+		placed = false;
+		for (uint32_t seed = 0; seed < FROZEN_MAX_SEED_TRIES && !placed; seed++) {
+			uint32_t i = first;
+			for (; i < last; i++) {
+				uint32_t pos = _frozen_position(hashes[members[i]], seed, slot_range);
+				if (taken[pos]) break;
+				taken[pos] = true;
+				positions[members[i]] = pos;
+			}
+			if (i == last) {
+				seeds[b] = seed;
+				placed = true;
+			}
+			else {
+				// undo the part of the bucket that did fit
+				for (uint32_t j = first; j < i; j++) {
+					taken[positions[members[j]]] = false;
+				}
+			}
+		}
+	}
+
+	free(bucket_start);
+	free(members);
+	free(order);
+	free(taken);
+	return placed;
+}
+
+// points a FrozenHash at a block laid out by hash_freeze
+static void _frozen_attach(FrozenHash *frozen, unsigned char *block) {
+	_FrozenHeader *header = (_FrozenHeader *)block;
+	frozen->block = block;
+	frozen->header = header;
+	frozen->count = header->count;
+	frozen->value_size = header->value_size;
+	frozen->seeds = (uint32_t *)(block + header->seeds_off);
+	frozen->remap = (uint32_t *)(block + header->remap_off);
+	frozen->slots = (_FrozenSlot *)(block + header->slots_off);
+	frozen->values = block + header->values_off;
+	frozen->keys = block + header->keys_off;
+}
+
+// checks that a block read from disk is a snapshot this code can use and that every
+// section it points at is inside the block
+static bool _frozen_valid(unsigned char *block, uint64_t size) {
+	if (size < sizeof(_FrozenHeader)) {
+		return false;
+	}
+	_FrozenHeader *header = (_FrozenHeader *)block;
+	if (header->magic != FROZEN_MAGIC || header->version != FROZEN_VERSION ||
+		header->total_size > size || header->slot_range < header->count ||
+		(header->count > 0 && header->bucket_count == 0) ||
+		header->value_stride < header->value_size || header->value_stride % 8 != 0) {
+		return false;
+	}
+	// the sections are read in place, so each has to be aligned for what it holds
+	if (header->seeds_off < sizeof(_FrozenHeader) ||
+		header->seeds_off % sizeof(uint32_t) != 0 || header->remap_off % sizeof(uint32_t) != 0 ||
+		header->slots_off % sizeof(uint64_t) != 0 || header->values_off % 8 != 0) {
+		return false;
+	}
+	// every section has to end before the next one starts, and the keys before the end of the
+	// block. a section can hold at most 2^32 * 2^32 bytes, so none of the lengths wrap
+	return _frozen_section(header->seeds_off, (uint64_t)header->bucket_count * sizeof(uint32_t), header->remap_off) &&
+		_frozen_section(header->remap_off, (uint64_t)(header->slot_range - header->count) * sizeof(uint32_t), header->slots_off) &&
+		_frozen_section(header->slots_off, (uint64_t)header->count * sizeof(_FrozenSlot), header->values_off) &&
+		_frozen_section(header->values_off, (uint64_t)header->count * header->value_stride, header->keys_off) &&
+		header->keys_off <= header->total_size;
+}
+
+// true if len bytes starting at off end by end. subtracts instead of adding, so a huge
+// offset can't wrap around to look like it fits
+static bool _frozen_section(uint64_t off, uint64_t len, uint64_t end) {
+	return off <= end && len <= end - off;
+}
+
+// releases a block opened by hash_map
+static void _frozen_unmap(unsigned char *block, uint64_t size, void *map_handle) {
+#ifdef _WIN32
+	(void)size;
+	UnmapViewOfFile(block);
+	CloseHandle(map_handle);
+#else
+	(void)map_handle;
+	munmap(block, (size_t)size);
+#endif
+}
+
+static uint64_t _align(uint64_t offset, uint64_t alignment) {
+	return (offset + alignment - 1) / alignment * alignment;
+}
@@ -0,0 +1,184 @@
+//---------------------------------------------------------
+// file:    frozenHash.h
+// author:  Jordan Hoffmann
+// brief:   Library for read only perfect hash tables built from a HashTable,
+//          and snapshots of them that can be memory mapped
+//---------------------------------------------------------
+
+#pragma once
+#include "hashTable.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// average number of keys that share one displacement seed
+#define FROZEN_KEYS_PER_BUCKET 4
+
+// seeds tried for one bucket before the whole build restarts with a new global seed
+#define FROZEN_MAX_SEED_TRIES (1 << 20)
+
+#define FROZEN_MAGIC 0x5A4F5246u	// "FROZ"
+#define FROZEN_VERSION 1
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+// start of every frozen block. everything after it is found by offset, never by pointer
+typedef struct {
+	uint32_t magic;			// FROZEN_MAGIC
+	uint32_t version;		// FROZEN_VERSION
+	uint32_t count;			// number of keys, which is also the number of slots
+	uint32_t bucket_count;	// number of displacement seeds
+	uint32_t slot_range;	// range the seeds place keys into (>= count)
+	uint32_t value_size;	// bytes in every value
+	uint32_t value_stride;	// distance between values (value_size rounded up to 8)
+	uint32_t reserved;
+	uint64_t seed;			// seed of the key hash
+	uint64_t seeds_off;		// uint32_t seed per bucket
+	uint64_t remap_off;		// uint32_t slot for every position past count
+	uint64_t slots_off;		// _FrozenSlot per key
+	uint64_t values_off;	// value_stride bytes per key
+	uint64_t keys_off;		// key bytes
+	uint64_t total_size;	// size of the whole block
+} _FrozenHeader;
+
+typedef struct {
+	uint64_t hash;			// full 64 bit hash of the key
+	uint64_t key_off;		// key bytes, relative to keys_off
+	uint32_t key_len;		// number of bytes in the key
+	uint32_t reserved;
+} _FrozenSlot;
+
+typedef struct {
+	int count;				// number of keys stored
+	int value_size;			// bytes in every value
+	unsigned char *block;	// the whole table: header, seeds, remap, slots, values and keys
+	_FrozenHeader *header;	// start of block
+	uint32_t *seeds;		// displacement seed of every bucket
+	uint32_t *remap;		// final slot of positions past count
+	_FrozenSlot *slots;		// one per key
+	unsigned char *values;	// value of slot i is at values + i * value_stride
+	unsigned char *keys;	// every key's bytes
+	bool mapped;			// block is a read only mapping of a file made by hash_save
+	void *map_handle;		// file mapping handle (windows only)
+} FrozenHash;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		builds a read only perfect hash table holding everything in a HashTable
+* @details		keys are grouped into buckets that each get a seed, chosen so every key lands
+*				in its own slot (hash and displace). the result has exactly one slot per key,
+*				so any lookup checks a single slot and then compares the key.
+*				everything lives in one contiguous block. the HashTable is left untouched.
+*				if a key is in the table more than once, only the value HASH_FIND returns is kept.
+*				values stored with fewer than value_size bytes are padded with zeros.
+*
+* @param[in]	hash_table - the table to freeze
+* @param[in]	value_size - the size of every value in the table. i.e sizeof(int)
+* @return		a newly allocated frozen table (free it with frozen_free), or NULL if it couldn't be built
+*/
+FrozenHash *hash_freeze(HashTable *hash_table, int value_size);
+
+/**
+* @brief		frees a frozen table
+* @details		tables opened with hash_map are unmapped instead
+*
+* @param[in]	frozen - the table to free
+*/
+void frozen_free(FrozenHash *frozen);
+
+/**
+* @brief		writes a snapshot of a hash table to a file
+* @details		the file is the block hash_freeze builds. it only holds offsets, never pointers,
+*				so hash_map can use it straight from the mapped pages. it is written in the
+*				machine's own byte order.
+*
+* @param[in]	hash_table - the table to save
+* @param[in]	path	   - the file to write
+* @param[in]	value_size - the size of every value in the table. i.e sizeof(int)
+* @return		1 if the file was written, 0 if it was not.
+*/
+bool hash_save(HashTable *hash_table, const char *path, int value_size);
+
+/**
+* @brief		writes an already frozen table to a file
+*
+* @param[in]	frozen - the table to save
+* @param[in]	path   - the file to write
+* @return		1 if the file was written, 0 if it was not.
+*/
+bool frozen_save(FrozenHash *frozen, const char *path);
+
+/**
+* @brief		opens a file written by hash_save without loading it
+* @details		the file is memory mapped read only and lookups run directly on the mapped
+*				pages, so opening costs the same no matter how many keys there are.
+*				the result is used like any other FrozenHash and closed with frozen_free.
+*				only the header and section bounds are checked when opening. every lookup checks
+*				the slot and key it reads, so a corrupt file gives wrong answers, never reads
+*				outside the mapping.
+*
+* @param[in]	path - the file to open
+* @return		the mapped table, or NULL if the file couldn't be mapped or isn't a snapshot
+*/
+FrozenHash *hash_map(const char *path);
+
+/**
+* @brief		boolian function used to determine weather a key is in a frozen table
+* @details		keys that were never added are rejected by comparing the key in the one slot checked
+*
+* @param[in]	frozen - the table to search
+* @param[in]	key	   - the key string to search for
+* @return		1 if the key is found, 0 if it was not.
+*/
+bool frozen_exists(FrozenHash *frozen, unsigned char *key);
+
+/**
+* @brief		boolian function used to determine weather a binary key is in a frozen table
+*
+* @param[in]	frozen  - the table to search
+* @param[in]	key	    - the key bytes to search for
+* @param[in]	key_len - the number of bytes in key
+* @return		1 if the key is found, 0 if it was not.
+*/
+bool frozen_exists_bin(FrozenHash *frozen, unsigned char *key, int key_len);
+
+/**
+* @brief		retrieves an item from a frozen table
+* @details		if the item isn't found, behavior is undefined. use frozen_exists() first.
+*
+* @param[in]	type_t	   - the type of data being accessed. i.e (int), (double *), etc.
+* @param[in]	frozen	   - the table to retrieve from
+* @param[in]	key_string - the lookup string the item was inserted with.
+*/
+#define FROZEN_FIND(type_t, frozen, key_string) (*(type_t *)__frozen_find(frozen, key_string, (int)strlen((char *)(key_string))))
+
+/**
+* @brief		retrieves an item stored under a binary key from a frozen table
+*
+* @param[in]	type_t	- the type of data being accessed. i.e (int), (double *), etc.
+* @param[in]	frozen	- the table to retrieve from
+* @param[in]	key		- the key bytes the item was inserted with.
+* @param[in]	key_len	- the number of bytes in key
+*/
+#define FROZEN_FIND_BIN(type_t, frozen, key, key_len) (*(type_t *)__frozen_find(frozen, key, key_len))
+
+/**
+* @brief		returns the number of keys in a frozen table
+*
+* @param[in]	frozen - the table you're querying the size of
+*/
+#define FROZEN_SIZE(frozen) ((frozen) ? (frozen)->count : 0)
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ignore these helper functions
+
+void *__frozen_find(FrozenHash *frozen, unsigned char *key, int key_len);
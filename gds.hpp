@@ -0,0 +1,862 @@
+//---------------------------------------------------------
+// file:    gds.hpp
+// author:  Jordan Hoffmann
+// brief:   header only C++ versions of the dynamic array, linked list
+//          and hash map, storing typed elements inline
+//---------------------------------------------------------
+
+#pragma once
+#include "allocator.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// capacity of an empty gds::DynArr once something is pushed to it (same as dna_create)
+#define GDS_DYNARR_MIN_CAPACITY 2
+
+// capacity of a gds::HashMap once something is added to it (same as INTMAP_MIN_CAPACITY)
+#define GDS_HASHMAP_MIN_CAPACITY 8
+
+namespace gds {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ignore these helper functions
+
+namespace detail {
+
+// the containers get their memory the same way the C ones do: from an Allocator, or malloc when it's NULL.
+// the allocator's function pointers are called directly so this header doesn't need the library linked in
+inline void *alloc(Allocator *allocator, size_t size) {
+	void *ptr = allocator ? (*allocator->alloc)(allocator->ctx, size) : std::malloc(size);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+// true when nothing needs to be destroyed or given back: the elements have no destructors to
+// run and the memory comes from a region, which releases it when it is dropped
+template <typename T>
+inline bool skip_free(Allocator *allocator) {
+	return std::is_trivially_destructible<T>::value && allocator && (allocator->flags & ALLOC_REGION);
+}
+
+inline void free(Allocator *allocator, void *ptr) {
+	if (!allocator) {
+		std::free(ptr);
+	}
+	else if (ptr) {
+		(*allocator->free)(allocator->ctx, ptr);
+	}
+}
+
+// spreads the bits of a std::hash result, which is the value itself for integers (murmur3 finalizer)
+inline uint64_t mix(uint64_t h) {
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+template <typename T>
+inline void destroy(T *items, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		items[i].~T();
+	}
+}
+
+// moves n items to uninitialized memory at dst and destroys the originals. types that can be
+// memcpy'd are, everything else is moved (or copied, if its move could throw and leave both halves broken)
+template <typename T>
+inline void relocate(T *src, T *dst, size_t n, std::true_type) {
+	if (n) {
+		std::memcpy(static_cast<void *>(dst), static_cast<const void *>(src), n * sizeof(T));
+	}
+}
+
+template <typename T>
+inline void relocate(T *src, T *dst, size_t n, std::false_type) {
+	size_t i = 0;
+	try {
+		for (; i < n; i++) {
+			new (dst + i) T(std::move_if_noexcept(src[i]));
+		}
+	}
+	catch (...) {
+		destroy(dst, i);
+		throw;
+	}
+	destroy(src, n);
+}
+
+template <typename T>
+inline void relocate(T *src, T *dst, size_t n) {
+	relocate(src, dst, n, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+}
+
+} // namespace detail
+
+//---------------------------------------------------------
+// Public Structures:
+//---------------------------------------------------------
+
+/**
+* @brief		a dynamic array of T, stored inline in one block
+* @details		the C++ version of DynArr. elements live in the array itself rather than
+*				in a malloc'd cell each, so pushing only allocates when the array grows,
+*				and they are constructed and destroyed like any C++ object. move only
+*				types (i.e std::unique_ptr) work. moving a whole array is O(1) and noexcept.
+*				memory comes from allocator (NULL uses malloc), which has to outlive the array.
+*/
+template <typename T>
+class DynArr {
+	static_assert(alignof(T) <= ALLOC_ALIGN, "gds::DynArr can't hold types aligned past ALLOC_ALIGN");
+
+public:
+	typedef T value_type;
+	typedef T *iterator;
+	typedef const T *const_iterator;
+
+	explicit DynArr(Allocator *allocator = NULL) : data_(NULL), size_(0), capacity_(0), allocator_(allocator) {}
+
+	DynArr(const DynArr &other) : data_(NULL), size_(0), capacity_(0), allocator_(other.allocator_) {
+		reserve(other.size_);
+		try {
+			for (; size_ < other.size_; size_++) {
+				new (data_ + size_) T(other.data_[size_]);
+			}
+		}
+		catch (...) {
+			// the destructor doesn't run for an object that never finished constructing
+			detail::destroy(data_, size_);
+			detail::free(allocator_, data_);
+			throw;
+		}
+	}
+
+	DynArr(DynArr &&other) noexcept : data_(other.data_), size_(other.size_), capacity_(other.capacity_), allocator_(other.allocator_) {
+		other.data_ = NULL;
+		other.size_ = 0;
+		other.capacity_ = 0;
+	}
+
+	DynArr &operator=(const DynArr &other) {
+		if (this != &other) {
+			DynArr copy(other);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	DynArr &operator=(DynArr &&other) noexcept {
+		DynArr moved(std::move(other));
+		swap(moved);
+		return *this;
+	}
+
+	~DynArr() {
+		if (!detail::skip_free<T>(allocator_)) {
+			clear();
+			detail::free(allocator_, data_);
+		}
+	}
+
+	void swap(DynArr &other) noexcept {
+		std::swap(data_, other.data_);
+		std::swap(size_, other.size_);
+		std::swap(capacity_, other.capacity_);
+		std::swap(allocator_, other.allocator_);
+	}
+
+	/**
+	* @brief		constructs an element at the back of the array from args
+	* @details		args may refer to an element of this array, even if it has to grow.
+	* @return		the new element
+	*/
+	template <typename... Args>
+	T &emplace(Args &&...args) {
+		if (size_ < capacity_) {
+			T *item = new (data_ + size_) T(std::forward<Args>(args)...);
+			size_++;
+			return *item;
+		}
+		// the new element is built before the old ones move, in case args points at one of them
+		size_t capacity = capacity_ ? capacity_ * 2 : GDS_DYNARR_MIN_CAPACITY;
+		T *data = static_cast<T *>(detail::alloc(allocator_, capacity * sizeof(T)));
+		T *item;
+		try {
+			item = new (data + size_) T(std::forward<Args>(args)...);
+			try {
+				detail::relocate(data_, data, size_);
+			}
+			catch (...) {
+				item->~T();
+				throw;
+			}
+		}
+		catch (...) {
+			detail::free(allocator_, data);
+			throw;
+		}
+		detail::free(allocator_, data_);
+		data_ = data;
+		capacity_ = capacity;
+		size_++;
+		return *item;
+	}
+
+	// adds a copy of val to the back of the array
+	T &push(const T &val) {
+		return emplace(val);
+	}
+
+	// moves val to the back of the array
+	T &push(T &&val) {
+		return emplace(std::move(val));
+	}
+
+	// removes the last element and returns it
+	T pop() {
+		T out(std::move(data_[size_ - 1]));
+		data_[--size_].~T();
+		return out;
+	}
+
+	// replaces the element at pos
+	template <typename U>
+	void put(size_t pos, U &&val) {
+		data_[pos] = std::forward<U>(val);
+	}
+
+	// destroys the element at pos and shifts every element after it to the left
+	void rem(size_t pos) {
+		for (size_t i = pos; i + 1 < size_; i++) {
+			data_[i] = std::move(data_[i + 1]);
+		}
+		data_[--size_].~T();
+	}
+
+	// destroys the last element
+	void rem_back() {
+		data_[--size_].~T();
+	}
+
+	// makes room for capacity elements without growing
+	void reserve(size_t capacity) {
+		if (capacity <= capacity_) {
+			return;
+		}
+		T *data = static_cast<T *>(detail::alloc(allocator_, capacity * sizeof(T)));
+		try {
+			detail::relocate(data_, data, size_);
+		}
+		catch (...) {
+			detail::free(allocator_, data);
+			throw;
+		}
+		detail::free(allocator_, data_);
+		data_ = data;
+		capacity_ = capacity;
+	}
+
+	// destroys every element, keeping the memory
+	void clear() {
+		detail::destroy(data_, size_);
+		size_ = 0;
+	}
+
+	T &operator[](size_t pos) { return data_[pos]; }
+	const T &operator[](size_t pos) const { return data_[pos]; }
+	T &back() { return data_[size_ - 1]; }
+	const T &back() const { return data_[size_ - 1]; }
+	T *data() { return data_; }
+	const T *data() const { return data_; }
+	size_t size() const { return size_; }
+	size_t capacity() const { return capacity_; }
+	bool empty() const { return size_ == 0; }
+	Allocator *allocator() const { return allocator_; }
+
+	iterator begin() { return data_; }
+	iterator end() { return data_ + size_; }
+	const_iterator begin() const { return data_; }
+	const_iterator end() const { return data_ + size_; }
+
+private:
+	T *data_;				// capacity_ slots, the first size_ holding elements
+	size_t size_;			// number of elements in the array
+	size_t capacity_;		// number of elements that fit before growing
+	Allocator *allocator_;	// where data_ comes from (or NULL for malloc)
+};
+
+/**
+* @brief		a doubly linked list of T, with every element inside its node
+* @details		the C++ version of LinkedList. one allocation per element (the node),
+*				instead of a node and a cell. a pool_allocator sized with node_size fits
+*				well. moving a whole list is O(1) and noexcept.
+*				memory comes from allocator (NULL uses malloc), which has to outlive the list.
+*/
+template <typename T>
+class List {
+	struct Node {
+		Node *next;
+		Node *prev;
+		T val;
+
+		template <typename... Args>
+		explicit Node(Args &&...args) : next(NULL), prev(NULL), val(std::forward<Args>(args)...) {}
+	};
+
+	static_assert(alignof(Node) <= ALLOC_ALIGN, "gds::List can't hold types aligned past ALLOC_ALIGN");
+
+	template <typename V>
+	class Iter {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef V *pointer;
+		typedef V &reference;
+
+		explicit Iter(Node *node = NULL) : node_(node) {}
+		// iterators convert to const_iterators
+		operator Iter<const T>() const { return Iter<const T>(node_); }
+
+		V &operator*() const { return node_->val; }
+		V *operator->() const { return &node_->val; }
+		Iter &operator++() { node_ = node_->next; return *this; }
+		Iter operator++(int) { Iter old = *this; node_ = node_->next; return old; }
+		bool operator==(const Iter &other) const { return node_ == other.node_; }
+		bool operator!=(const Iter &other) const { return node_ != other.node_; }
+
+	private:
+		friend class List;
+		Node *node_;
+	};
+
+public:
+	typedef T value_type;
+	typedef Iter<T> iterator;
+	typedef Iter<const T> const_iterator;
+
+	// bytes taken by every node, i.e pool_create(gds::List<T>::node_size + COUNTERS_OVERHEAD, 256, NULL)
+	static const size_t node_size = sizeof(Node);
+
+	explicit List(Allocator *allocator = NULL) : head_(NULL), tail_(NULL), size_(0), allocator_(allocator) {}
+
+	List(const List &other) : head_(NULL), tail_(NULL), size_(0), allocator_(other.allocator_) {
+		try {
+			for (Node *node = other.head_; node; node = node->next) {
+				emplace_back(node->val);
+			}
+		}
+		catch (...) {
+			clear();
+			throw;
+		}
+	}
+
+	List(List &&other) noexcept : head_(other.head_), tail_(other.tail_), size_(other.size_), allocator_(other.allocator_) {
+		other.head_ = NULL;
+		other.tail_ = NULL;
+		other.size_ = 0;
+	}
+
+	List &operator=(const List &other) {
+		if (this != &other) {
+			List copy(other);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	List &operator=(List &&other) noexcept {
+		List moved(std::move(other));
+		swap(moved);
+		return *this;
+	}
+
+	~List() {
+		// on a region there's nothing to gain from visiting every node
+		if (!detail::skip_free<T>(allocator_)) {
+			clear();
+		}
+	}
+
+	void swap(List &other) noexcept {
+		std::swap(head_, other.head_);
+		std::swap(tail_, other.tail_);
+		std::swap(size_, other.size_);
+		std::swap(allocator_, other.allocator_);
+	}
+
+	// constructs an element at the front of the list from args
+	template <typename... Args>
+	T &emplace_front(Args &&...args) {
+		Node *node = _create(std::forward<Args>(args)...);
+		node->next = head_;
+		if (head_) {
+			head_->prev = node;
+		}
+		else {
+			tail_ = node;
+		}
+		head_ = node;
+		size_++;
+		return node->val;
+	}
+
+	// constructs an element at the back of the list from args
+	template <typename... Args>
+	T &emplace_back(Args &&...args) {
+		Node *node = _create(std::forward<Args>(args)...);
+		node->prev = tail_;
+		if (tail_) {
+			tail_->next = node;
+		}
+		else {
+			head_ = node;
+		}
+		tail_ = node;
+		size_++;
+		return node->val;
+	}
+
+	T &push_front(const T &val) { return emplace_front(val); }
+	T &push_front(T &&val) { return emplace_front(std::move(val)); }
+	T &push_back(const T &val) { return emplace_back(val); }
+	T &push_back(T &&val) { return emplace_back(std::move(val)); }
+
+	// removes the first element and returns it
+	T pop_front() {
+		T out(std::move(head_->val));
+		rem_front();
+		return out;
+	}
+
+	// removes the last element and returns it
+	T pop_back() {
+		T out(std::move(tail_->val));
+		rem_back();
+		return out;
+	}
+
+	// destroys the first element
+	void rem_front() {
+		_unlink(head_);
+	}
+
+	// destroys the last element
+	void rem_back() {
+		_unlink(tail_);
+	}
+
+	/**
+	* @brief		destroys the element it points at
+	* @return		an iterator to the element after it
+	*/
+	iterator rem(iterator it) {
+		Node *next = it.node_->next;
+		_unlink(it.node_);
+		return iterator(next);
+	}
+
+	// destroys every element
+	void clear() {
+		while (head_) {
+			Node *next = head_->next;
+			head_->~Node();
+			detail::free(allocator_, head_);
+			head_ = next;
+		}
+		tail_ = NULL;
+		size_ = 0;
+	}
+
+	T &front() { return head_->val; }
+	const T &front() const { return head_->val; }
+	T &back() { return tail_->val; }
+	const T &back() const { return tail_->val; }
+	size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	Allocator *allocator() const { return allocator_; }
+
+	iterator begin() { return iterator(head_); }
+	iterator end() { return iterator(); }
+	const_iterator begin() const { return const_iterator(head_); }
+	const_iterator end() const { return const_iterator(); }
+
+private:
+	Node *head_;			// first node (or NULL)
+	Node *tail_;			// last node (or NULL)
+	size_t size_;			// number of elements in the list
+	Allocator *allocator_;	// where nodes come from (or NULL for malloc)
+
+	template <typename... Args>
+	Node *_create(Args &&...args) {
+		void *mem = detail::alloc(allocator_, sizeof(Node));
+		try {
+			return new (mem) Node(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			detail::free(allocator_, mem);
+			throw;
+		}
+	}
+
+	void _unlink(Node *node) {
+		if (node->prev) {
+			node->prev->next = node->next;
+		}
+		else {
+			head_ = node->next;
+		}
+		if (node->next) {
+			node->next->prev = node->prev;
+		}
+		else {
+			tail_ = node->prev;
+		}
+		node->~Node();
+		detail::free(allocator_, node);
+		size_--;
+	}
+};
+
+/**
+* @brief		a hash map from K to V, with keys and values stored inline
+* @details		the C++ version of intMap.h's maps, for any key std::hash (or Hash) handles:
+*				one open addressed array probed linearly, removal shifting later keys back
+*				so there are no tombstones. every slot keeps 32 bits of its key's hash, so
+*				probes only run Eq on a probable match and growing never rehashes a key.
+*				pointers to values stay valid until the map grows or a key is removed.
+*				moving a whole map is O(1) and noexcept.
+*				memory comes from allocator (NULL uses malloc), which has to outlive the map.
+*/
+template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K> >
+class HashMap {
+public:
+	// a key and its value. don't change key while it's in the map
+	struct Entry {
+		K key;
+		V val;
+
+		// kept away from Entry arguments, which go to the copy and move constructors
+		template <typename KK, typename... Args, typename = typename std::enable_if<!std::is_same<typename std::decay<KK>::type, Entry>::value>::type>
+		Entry(KK &&k, Args &&...args) : key(std::forward<KK>(k)), val(std::forward<Args>(args)...) {}
+	};
+
+private:
+	static_assert(alignof(Entry) <= ALLOC_ALIGN, "gds::HashMap can't hold types aligned past ALLOC_ALIGN");
+
+	template <typename E>
+	class Iter {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Entry value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef E *pointer;
+		typedef E &reference;
+
+		Iter(const HashMap *map, size_t pos) : map_(map), pos_(pos) { _skip(); }
+		operator Iter<const Entry>() const { return Iter<const Entry>(map_, pos_); }
+
+		E &operator*() const { return map_->entries_[pos_]; }
+		E *operator->() const { return &map_->entries_[pos_]; }
+		Iter &operator++() { pos_++; _skip(); return *this; }
+		Iter operator++(int) { Iter old = *this; ++*this; return old; }
+		bool operator==(const Iter &other) const { return pos_ == other.pos_; }
+		bool operator!=(const Iter &other) const { return pos_ != other.pos_; }
+
+	private:
+		const HashMap *map_;
+		size_t pos_;
+
+		void _skip() {
+			while (pos_ < map_->capacity_ && !map_->hashes_[pos_]) {
+				pos_++;
+			}
+		}
+	};
+
+public:
+	typedef Entry value_type;
+	typedef Iter<Entry> iterator;
+	typedef Iter<const Entry> const_iterator;
+
+	explicit HashMap(Allocator *allocator = NULL) : hashes_(NULL), entries_(NULL), count_(0), capacity_(0), allocator_(allocator) {}
+
+	HashMap(const HashMap &other) : hashes_(NULL), entries_(NULL), count_(0), capacity_(0), allocator_(other.allocator_) {
+		if (!other.count_) {
+			return;
+		}
+		// same capacity and hashes, so every entry goes to the slot it has in other
+		_alloc_slots(other.capacity_);
+		size_t i = 0;
+		try {
+			for (; i < capacity_; i++) {
+				if (other.hashes_[i]) {
+					new (entries_ + i) Entry(other.entries_[i]);
+					hashes_[i] = other.hashes_[i];
+				}
+			}
+		}
+		catch (...) {
+			for (size_t j = 0; j < i; j++) {
+				if (hashes_[j]) entries_[j].~Entry();
+			}
+			detail::free(allocator_, hashes_);
+			throw;
+		}
+		count_ = other.count_;
+	}
+
+	HashMap(HashMap &&other) noexcept : hashes_(other.hashes_), entries_(other.entries_), count_(other.count_), capacity_(other.capacity_), allocator_(other.allocator_) {
+		other.hashes_ = NULL;
+		other.entries_ = NULL;
+		other.count_ = 0;
+		other.capacity_ = 0;
+	}
+
+	HashMap &operator=(const HashMap &other) {
+		if (this != &other) {
+			HashMap copy(other);
+			swap(copy);
+		}
+		return *this;
+	}
+
+	HashMap &operator=(HashMap &&other) noexcept {
+		HashMap moved(std::move(other));
+		swap(moved);
+		return *this;
+	}
+
+	~HashMap() {
+		if (!detail::skip_free<Entry>(allocator_)) {
+			clear();
+			detail::free(allocator_, hashes_);
+		}
+	}
+
+	void swap(HashMap &other) noexcept {
+		std::swap(hashes_, other.hashes_);
+		std::swap(entries_, other.entries_);
+		std::swap(count_, other.count_);
+		std::swap(capacity_, other.capacity_);
+		std::swap(allocator_, other.allocator_);
+	}
+
+	/**
+	* @brief		adds key with a value constructed from args, unless the key is already there
+	* @details		nothing is constructed for a key that's already there, and its value is left alone.
+	* @return		the value stored under key
+	*/
+	template <typename KK, typename... Args>
+	V &emplace(KK &&key, Args &&...args) {
+		// grows before looking, like intMap's put, so pos stays good for the new entry
+		if ((count_ + 1) * 10 > capacity_ * 7) {
+			_grow();
+		}
+		uint32_t hash = _hash(key);
+		size_t pos = 0;
+		if (_find(key, hash, &pos)) {
+			return entries_[pos].val;
+		}
+		new (entries_ + pos) Entry(std::forward<KK>(key), std::forward<Args>(args)...);
+		hashes_[pos] = hash;
+		count_++;
+		return entries_[pos].val;
+	}
+
+	// adds key with val, or replaces the value already stored under key
+	template <typename KK, typename VV>
+	V &put(KK &&key, VV &&val) {
+		size_t count = count_;
+		V &stored = emplace(std::forward<KK>(key), std::forward<VV>(val));
+		if (count_ == count) {
+			stored = std::forward<VV>(val);
+		}
+		return stored;
+	}
+
+	// the value stored under key, default constructing it if the key isn't there
+	template <typename KK>
+	V &operator[](KK &&key) {
+		return emplace(std::forward<KK>(key));
+	}
+
+	// the value stored under key, or NULL if the key isn't there
+	V *find(const K &key) {
+		size_t pos;
+		return _find(key, _hash(key), &pos) ? &entries_[pos].val : NULL;
+	}
+
+	const V *find(const K &key) const {
+		size_t pos;
+		return _find(key, _hash(key), &pos) ? &entries_[pos].val : NULL;
+	}
+
+	bool exists(const K &key) const {
+		return find(key) != NULL;
+	}
+
+	/**
+	* @brief		removes key and destroys its value
+	* @return		false if the key wasn't there
+	*/
+	bool rem(const K &key) {
+		size_t pos;
+		if (!_find(key, _hash(key), &pos)) {
+			return false;
+		}
+		size_t mask = capacity_ - 1;
+		entries_[pos].~Entry();
+		// shift back every later key that would otherwise be cut off from its home
+		size_t next = (pos + 1) & mask;
+		while (hashes_[next]) {
+			size_t home = hashes_[next] & mask;
+			if (((next - home) & mask) >= ((next - pos) & mask)) {
+				new (entries_ + pos) Entry(std::move(entries_[next]));
+				entries_[next].~Entry();
+				hashes_[pos] = hashes_[next];
+				pos = next;
+			}
+			next = (next + 1) & mask;
+		}
+		hashes_[pos] = 0;
+		count_--;
+		return true;
+	}
+
+	// makes room for count keys without growing
+	void reserve(size_t count) {
+		size_t capacity = capacity_ ? capacity_ : GDS_HASHMAP_MIN_CAPACITY;
+		while (capacity * 7 < count * 10) {
+			capacity *= 2;
+		}
+		if (capacity > capacity_) {
+			_rehash(capacity);
+		}
+	}
+
+	// destroys every key and value, keeping the memory
+	void clear() {
+		for (size_t i = 0; i < capacity_ && count_; i++) {
+			if (hashes_[i]) {
+				entries_[i].~Entry();
+				hashes_[i] = 0;
+				count_--;
+			}
+		}
+	}
+
+	size_t size() const { return count_; }
+	size_t capacity() const { return capacity_; }
+	bool empty() const { return count_ == 0; }
+	Allocator *allocator() const { return allocator_; }
+
+	// order is unspecified. don't add or remove keys while iterating
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, capacity_); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, capacity_); }
+
+private:
+	uint32_t *hashes_;		// low 32 bits of each slot's hash with the top bit set, or 0 when it's empty
+	Entry *entries_;		// capacity_ slots, following hashes_ in the same block
+	size_t count_;			// number of keys stored
+	size_t capacity_;		// number of slots (0, or a power of 2 up to 2^31)
+	Allocator *allocator_;	// where the slots come from (or NULL for malloc)
+
+	// the top bit marks a used slot, and is above any index bit
+	static uint32_t _hash(const K &key) {
+		return (uint32_t)detail::mix((uint64_t)Hash()(key)) | 0x80000000u;
+	}
+
+	// returns true with the key's slot in pos, or false with the empty slot it would go in
+	bool _find(const K &key, uint32_t hash, size_t *pos) const {
+		if (!capacity_) {
+			return false;
+		}
+		size_t mask = capacity_ - 1;
+		size_t i = hash & mask;
+		while (hashes_[i]) {
+			if (hashes_[i] == hash && Eq()(entries_[i].key, key)) {
+				*pos = i;
+				return true;
+			}
+			i = (i + 1) & mask;
+		}
+		*pos = i;
+		return false;
+	}
+
+	static size_t _entries_offset(size_t capacity) {
+		return (capacity * sizeof(uint32_t) + ALLOC_ALIGN - 1) & ~(size_t)(ALLOC_ALIGN - 1);
+	}
+
+	// points hashes_ and entries_ at a new, empty block of capacity slots
+	void _alloc_slots(size_t capacity) {
+		size_t offset = _entries_offset(capacity);
+		unsigned char *block = static_cast<unsigned char *>(detail::alloc(allocator_, offset + capacity * sizeof(Entry)));
+		hashes_ = reinterpret_cast<uint32_t *>(block);
+		entries_ = reinterpret_cast<Entry *>(block + offset);
+		std::memset(hashes_, 0, capacity * sizeof(uint32_t));
+		capacity_ = capacity;
+	}
+
+	void _grow() {
+		_rehash(capacity_ ? capacity_ * 2 : GDS_HASHMAP_MIN_CAPACITY);
+	}
+
+	// moves every entry to a new block of capacity slots, using the hash each slot kept
+	void _rehash(size_t capacity) {
+		uint32_t *old_hashes = hashes_;
+		Entry *old_entries = entries_;
+		size_t old_capacity = capacity_;
+		_alloc_slots(capacity);
+		size_t mask = capacity - 1;
+		size_t i = 0;
+		try {
+			for (; i < old_capacity; i++) {
+				if (old_hashes[i]) {
+					size_t pos = old_hashes[i] & mask;
+					while (hashes_[pos]) {
+						pos = (pos + 1) & mask;
+					}
+					new (entries_ + pos) Entry(std::move_if_noexcept(old_entries[i]));
+					hashes_[pos] = old_hashes[i];
+				}
+			}
+		}
+		catch (...) {
+			// the old block is still whole, so put it back
+			for (size_t j = 0; j < capacity; j++) {
+				if (hashes_[j]) entries_[j].~Entry();
+			}
+			detail::free(allocator_, hashes_);
+			hashes_ = old_hashes;
+			entries_ = old_entries;
+			capacity_ = old_capacity;
+			throw;
+		}
+		for (size_t j = 0; j < old_capacity; j++) {
+			if (old_hashes[j]) old_entries[j].~Entry();
+		}
+		detail::free(allocator_, old_hashes);
+	}
+};
+
+} // namespace gds
@@ -0,0 +1,340 @@
+//---------------------------------------------------------
+// file:    hashSet.c
+// author:  Jordan Hoffmann
+// brief:   Library for hash sets, tables of keys without values
+//---------------------------------------------------------
+
+#include "hashSet.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static unsigned default_hash(unsigned char *key, int key_len);
+static int _hset_size_for(int count);
+static int _hset_probe(HashSet *set, unsigned char *key, int key_len, unsigned hash, bool *found);
+static bool _hset_add_hashed(HashSet *set, unsigned char *key, int key_len, unsigned hash);
+static void _hset_insert(HashSet *set, unsigned hash, int key_len, int key_off);
+static void _hset_remove_slot(HashSet *set, int slot);
+static void _hset_rebuild(HashSet *set, int size);
+static int _hset_store_key(HashSet *set, unsigned char *key, int key_len);
+static unsigned _hset_rehash(HashSet *set, HashSet *from, _HSetSlot *slot);
+static void _hset_retain(HashSet *set, HashSet *other, bool in_other);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+HashSet *hset_create(unsigned(hash_func)(unsigned char *, int)) {
+	HashSet *set = malloc(sizeof(HashSet));
+	if (!set) {
+		printf("failed to allocate hash set");
+		return NULL;
+	}
+	set->count = 0;
+	set->size = 0;
+	set->slots = NULL;
+	set->keys = NULL;
+	set->keys_used = 0;
+	set->keys_capacity = 0;
+	set->keys_dead = 0;
+	set->hash_func = hash_func ? hash_func : default_hash;
+	_hset_rebuild(set, HSET_MIN_SIZE);
+	return set;
+}
+
+HashSet *hset_copy(HashSet *set) {
+	HashSet *new_set = malloc(sizeof(HashSet));
+	if (!new_set) {
+		printf("failed to allocate hash set");
+		return NULL;
+	}
+	*new_set = *set;
+	new_set->slots = malloc(set->size * sizeof(_HSetSlot));
+	new_set->keys = malloc(set->keys_capacity ? set->keys_capacity : 1);
+	if (!new_set->slots || !new_set->keys) {
+		printf("failed to allocate hash set copy");
+		free(new_set->slots);
+		free(new_set->keys);
+		free(new_set);
+		return NULL;
+	}
+	memcpy(new_set->slots, set->slots, set->size * sizeof(_HSetSlot));
+	memcpy(new_set->keys, set->keys, set->keys_used);
+	return new_set;
+}
+
+void hset_free(HashSet *set) {
+	if (set) {
+		free(set->slots);
+		free(set->keys);
+		free(set);
+	}
+}
+
+void hset_clear(HashSet *set) {
+	for (int i = 0; i < set->size; i++) {
+		set->slots[i].key_len = HSET_EMPTY;
+	}
+	set->count = 0;
+	set->keys_used = 0;
+	set->keys_dead = 0;
+}
+
+void hset_reserve(HashSet *set, int capacity) {
+	int size = _hset_size_for(capacity);
+	if (size > set->size) {
+		_hset_rebuild(set, size);
+	}
+}
+
+bool hset_add(HashSet *set, unsigned char *key, int key_len) {
+	return _hset_add_hashed(set, key, key_len, (*set->hash_func)(key, key_len));
+}
+
+bool hset_contains(HashSet *set, unsigned char *key, int key_len) {
+	bool found;
+	_hset_probe(set, key, key_len, (*set->hash_func)(key, key_len), &found);
+	return found;
+}
+
+bool hset_rem(HashSet *set, unsigned char *key, int key_len) {
+	bool found;
+	int slot = _hset_probe(set, key, key_len, (*set->hash_func)(key, key_len), &found);
+	if (!found) {
+		return false;
+	}
+	_hset_remove_slot(set, slot);
+
+	// key bytes are only reclaimed by a rebuild, so sets that churn without growing need one too
+	if (set->keys_dead > set->keys_used - set->keys_dead) {
+		_hset_rebuild(set, set->size);
+	}
+	return true;
+}
+
+void hset_union(HashSet *set, HashSet *other) {
+	if (set == other) {
+		return;
+	}
+	hset_reserve(set, set->count > other->count ? set->count : other->count);
+	for (int i = 0; i < other->size; i++) {
+		_HSetSlot *slot = &other->slots[i];
+		if (slot->key_len != HSET_EMPTY) {
+			_hset_add_hashed(set, other->keys + slot->key_off, slot->key_len, _hset_rehash(set, other, slot));
+		}
+	}
+}
+
+void hset_intersect(HashSet *set, HashSet *other) {
+	if (set != other) {
+		_hset_retain(set, other, true);
+	}
+}
+
+void hset_difference(HashSet *set, HashSet *other) {
+	if (set == other) {
+		hset_clear(set);
+	}
+	else {
+		_hset_retain(set, other, false);
+	}
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// FNV-1a, the same as HashTable's default
+static unsigned default_hash(unsigned char *key, int key_len) {
+	unsigned h = 2166136261u;
+	for (int i = 0; i < key_len; i++) {
+		h ^= key[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+// smallest power of 2 that keeps count keys at most 70% full
+static int _hset_size_for(int count) {
+	int size = HSET_MIN_SIZE;
+	while (size * 7 < count * 10) {
+		size *= 2;
+	}
+	return size;
+}
+
+// walks key's probe run. returns the slot holding it with found set, or the empty
+// slot that ends the run, which is where the key would go
+static int _hset_probe(HashSet *set, unsigned char *key, int key_len, unsigned hash, bool *found) {
+	unsigned mask = set->size - 1;
+	unsigned slot = hash & mask;
+	while (set->slots[slot].key_len != HSET_EMPTY) {
+		_HSetSlot *s = &set->slots[slot];
+		if (s->hash == hash && s->key_len == key_len && memcmp(set->keys + s->key_off, key, key_len) == 0) {
+			*found = true;
+			return (int)slot;
+		}
+		slot = (slot + 1) & mask;
+	}
+	*found = false;
+	return (int)slot;
+}
+
+// hset_add with the key already hashed by set's hash function
+static bool _hset_add_hashed(HashSet *set, unsigned char *key, int key_len, unsigned hash) {
+	bool found;
+	int slot = _hset_probe(set, key, key_len, hash, &found);
+	if (found) {
+		return false;
+	}
+	if ((set->count + 1) * 10 > set->size * 7) {
+		// the rebuild may pack the key bytes, so the key is only stored after it
+		_hset_rebuild(set, set->size * 2);
+		_hset_insert(set, hash, key_len, _hset_store_key(set, key, key_len));
+	}
+	else {
+		// the probe already found the empty slot, so it isn't walked twice
+		set->slots[slot].hash = hash;
+		set->slots[slot].key_len = key_len;
+		set->slots[slot].key_off = _hset_store_key(set, key, key_len);
+	}
+	set->count++;
+	return true;
+}
+
+// puts a key that isn't in the set yet in the first empty slot of its probe run
+static void _hset_insert(HashSet *set, unsigned hash, int key_len, int key_off) {
+	unsigned mask = set->size - 1;
+	unsigned slot = hash & mask;
+	while (set->slots[slot].key_len != HSET_EMPTY) {
+		slot = (slot + 1) & mask;
+	}
+	set->slots[slot].hash = hash;
+	set->slots[slot].key_len = key_len;
+	set->slots[slot].key_off = key_off;
+}
+
+// empties a slot, then moves later keys of the run back into the hole whenever the
+// hole is still on their probe path, so every key stays reachable without tombstones
+static void _hset_remove_slot(HashSet *set, int slot) {
+	unsigned mask = set->size - 1;
+	unsigned hole = (unsigned)slot;
+	unsigned next = hole;
+	set->keys_dead += set->slots[slot].key_len + 1;
+	set->count--;
+	for (;;) {
+		next = (next + 1) & mask;
+		if (set->slots[next].key_len == HSET_EMPTY) {
+			break;
+		}
+		// distance from the key's home slot, to the hole and to where it is now
+		unsigned home = set->slots[next].hash & mask;
+		if (((hole - home) & mask) < ((next - home) & mask)) {
+			set->slots[hole] = set->slots[next];
+			hole = next;
+		}
+	}
+	set->slots[hole].key_len = HSET_EMPTY;
+}
+
+// replaces the slots with size empty ones and places every key again. removed key
+// bytes are packed out at the same time, since every key is being visited anyway
+static void _hset_rebuild(HashSet *set, int size) {
+	_HSetSlot *slots = malloc(size * sizeof(_HSetSlot));
+	if (!slots) {
+		printf("failed to allocate hash set slots");
+		return;
+	}
+	for (int i = 0; i < size; i++) {
+		slots[i].key_len = HSET_EMPTY;
+	}
+	unsigned char *old_keys = set->keys;
+	unsigned char *keys = old_keys;
+	if (set->keys_dead) {
+		int capacity = set->keys_used - set->keys_dead;
+		if (capacity < 64) capacity = 64;
+		keys = malloc(capacity);
+		if (keys) {
+			set->keys_used = 0;
+			set->keys_capacity = capacity;
+			set->keys_dead = 0;
+		}
+		else {
+			keys = old_keys;
+		}
+	}
+
+	_HSetSlot *old_slots = set->slots;
+	int old_size = set->size;
+	set->slots = slots;
+	set->size = size;
+	for (int i = 0; i < old_size; i++) {
+		_HSetSlot slot = old_slots[i];
+		if (slot.key_len == HSET_EMPTY) {
+			continue;
+		}
+		if (keys != old_keys) {
+			memcpy(keys + set->keys_used, old_keys + slot.key_off, slot.key_len + 1);
+			slot.key_off = set->keys_used;
+			set->keys_used += slot.key_len + 1;
+		}
+		_hset_insert(set, slot.hash, slot.key_len, slot.key_off);
+	}
+	if (keys != old_keys) {
+		free(old_keys);
+		set->keys = keys;
+	}
+	free(old_slots);
+}
+
+// appends a '\0' terminated copy of key to the key bytes and returns where it starts
+static int _hset_store_key(HashSet *set, unsigned char *key, int key_len) {
+	if (set->keys_used + key_len + 1 > set->keys_capacity) {
+		int capacity = set->keys_capacity ? set->keys_capacity * 2 : 64;
+		while (capacity < set->keys_used + key_len + 1) {
+			capacity *= 2;
+		}
+		unsigned char *keys = realloc(set->keys, capacity);
+		if (!keys) {
+			printf("failed to allocate hash set keys");
+			return 0;
+		}
+		set->keys = keys;
+		set->keys_capacity = capacity;
+	}
+	int key_off = set->keys_used;
+	memcpy(set->keys + key_off, key, key_len);
+	set->keys[key_off + key_len] = '\0';
+	set->keys_used += key_len + 1;
+	return key_off;
+}
+
+// the hash set's hash function gives a key stored in from, reusing the cached one when they match
+static unsigned _hset_rehash(HashSet *set, HashSet *from, _HSetSlot *slot) {
+	if (set->hash_func == from->hash_func) {
+		return slot->hash;
+	}
+	return (*set->hash_func)(from->keys + slot->key_off, slot->key_len);
+}
+
+// keeps only the keys of set that are (in_other) or aren't in other. dropped slots are just
+// emptied during the pass, which breaks probe runs, so the slots are rebuilt once at the end
+static void _hset_retain(HashSet *set, HashSet *other, bool in_other) {
+	for (int i = 0; i < set->size; i++) {
+		_HSetSlot *slot = &set->slots[i];
+		if (slot->key_len == HSET_EMPTY) {
+			continue;
+		}
+		bool found;
+		_hset_probe(other, set->keys + slot->key_off, slot->key_len, _hset_rehash(other, set, slot), &found);
+		if (found != in_other) {
+			set->keys_dead += slot->key_len + 1;
+			slot->key_len = HSET_EMPTY;
+			set->count--;
+		}
+	}
+	int size = _hset_size_for(set->count);
+	_hset_rebuild(set, size < set->size ? size : set->size);
+}
@@ -0,0 +1,204 @@
+//---------------------------------------------------------
+// file:    hashSet.h
+// author:  Jordan Hoffmann
+// brief:   Library for hash sets, tables of keys without values
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+#include <string.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// number of slots in a new set
+#define HSET_MIN_SIZE 8
+
+// key_len of a slot that holds no key
+#define HSET_EMPTY -1
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+typedef struct {
+	unsigned hash;			// full hash of the key
+	int key_len;			// number of bytes in the key, HSET_EMPTY if the slot is free
+	int key_off;			// where the key starts in keys
+} _HSetSlot;
+
+typedef struct {
+	int count;				// number of keys stored
+	int size;				// number of slots (power of 2)
+	_HSetSlot *slots;		// open addressed slots, probed linearly
+	unsigned char *keys;	// every key's bytes, each followed by '\0'
+	int keys_used;			// bytes of keys in use, including removed keys
+	int keys_capacity;		// bytes of keys allocated
+	int keys_dead;			// bytes of keys that were removed
+	unsigned(*hash_func)(unsigned char *, int);	// function used to hash keys
+} HashSet;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		Allocates and initializes a new HashSet ptr
+* @details		a HashSet only stores keys, so there is no value to allocate or copy.
+*				slots are one flat array probed in order, holding each key's cached hash,
+*				so a lookup usually reads one cache line before comparing any key bytes.
+*				keys are copied into the set.
+*
+* @param[in]	hash_func - function that takes a key and its length and returns a "unique"
+*				unsigned int, or NULL for a default hashing function.
+* @return		a pointer to a newly allocated and empty set
+*/
+HashSet *hset_create(unsigned(hash_func)(unsigned char *, int));
+
+/**
+* @brief		Allocates and initializes a copy of another set
+*
+* @param[in]	set - the set to copy
+* @return		a new HashSet holding every key in set
+*/
+HashSet *hset_copy(HashSet *set);
+
+/**
+* @brief		frees a set and all of its keys
+*
+* @param[in]	set - the set to free
+*/
+void hset_free(HashSet *set);
+
+/**
+* @brief		removes every key from a set, keeping its memory for reuse
+*
+* @param[in]	set - the set to clear
+*/
+void hset_clear(HashSet *set);
+
+/**
+* @brief		makes room for capacity keys in total, so adding them never grows the set
+*
+* @param[in]	set		 - the set to grow
+* @param[in]	capacity - the total number of keys the set should hold without growing
+*/
+void hset_reserve(HashSet *set, int capacity);
+
+/**
+* @brief		adds a key to a set
+* @details		returns weather the key was new, so deduplicating is a single call.
+*
+* @param[in]	set		- the set to add to
+* @param[in]	key		- the key bytes (copied)
+* @param[in]	key_len	- the number of bytes in key
+* @return		1 if the key was added, 0 if it was already in the set
+*/
+bool hset_add(HashSet *set, unsigned char *key, int key_len);
+
+/**
+* @brief		boolian function used to determine weather a key is in a set
+*
+* @param[in]	set		- the set to search
+* @param[in]	key		- the key bytes to search for
+* @param[in]	key_len	- the number of bytes in key
+* @return		1 if the key is found, 0 if it was not.
+*/
+bool hset_contains(HashSet *set, unsigned char *key, int key_len);
+
+/**
+* @brief		removes a key from a set
+* @details		later keys in the probe run are shifted back, so removals leave no markers
+*				behind for lookups to step over.
+*
+* @param[in]	set		- the set to remove from
+* @param[in]	key		- the key bytes to search for
+* @param[in]	key_len	- the number of bytes in key
+* @return		1 if the key was removed, 0 if it wasn't in the set.
+*/
+bool hset_rem(HashSet *set, unsigned char *key, int key_len);
+
+/**
+* @brief		adds every key of other to set
+* @details		when both sets use the same hash function the cached hashes are reused,
+*				so no key is hashed again.
+*
+* @param[in]	set	  - the set to add to
+* @param[in]	other - the set whose keys are added (unchanged)
+*/
+void hset_union(HashSet *set, HashSet *other);
+
+/**
+* @brief		removes every key of set that isn't in other
+* @details		done in one pass over set, then the slots are rebuilt once.
+*
+* @param[in]	set	  - the set to remove from
+* @param[in]	other - the set of keys to keep (unchanged)
+*/
+void hset_intersect(HashSet *set, HashSet *other);
+
+/**
+* @brief		removes every key of set that is in other
+* @details		done in one pass over set, then the slots are rebuilt once.
+*
+* @param[in]	set	  - the set to remove from
+* @param[in]	other - the set of keys to remove (unchanged)
+*/
+void hset_difference(HashSet *set, HashSet *other);
+
+/**
+* @brief		adds a string key to a set
+*
+* @param[in]	set		   - the set to add to
+* @param[in]	key_string - the key to add
+* @return		1 if the key was added, 0 if it was already in the set
+*/
+#define HSET_ADD(set, key_string) hset_add(set, key_string, (int)strlen((char *)(key_string)))
+
+/**
+* @brief		checks weather a string key is in a set
+*
+* @param[in]	set		   - the set to search
+* @param[in]	key_string - the key to search for
+*/
+#define HSET_CONTAINS(set, key_string) hset_contains(set, key_string, (int)strlen((char *)(key_string)))
+
+/**
+* @brief		removes a string key from a set
+*
+* @param[in]	set		   - the set to remove from
+* @param[in]	key_string - the key to remove
+*/
+#define HSET_REM(set, key_string) hset_rem(set, key_string, (int)strlen((char *)(key_string)))
+
+/**
+* @brief		run code with every key in a set
+* @details		keys are '\0' terminated copies, so string keys can be used as strings.
+*				the order is arbitrary. don't add or remove keys inside run.
+* @note         the variable name _ii can not be used with this function
+*
+* @param[in]	key_item - your chosen variable name for the current key (unsigned char *)
+* @param[in]	len_item - your chosen variable name for the current key's length (int)
+* @param[in]	set		 - the set you're itterating through
+* @param[in]	run		 - the code you would like to run. this can be multiple lines long
+*/
+#define HSET_FOREACH(key_item, len_item, set, run)											\
+do {																						\
+	if (set) {																				\
+		for (int _ii = 0; _ii < (set)->size; _ii++) {										\
+			if ((set)->slots[_ii].key_len != HSET_EMPTY) {									\
+				unsigned char *key_item = (set)->keys + (set)->slots[_ii].key_off;			\
+				int len_item = (set)->slots[_ii].key_len;									\
+				run;																		\
+			}																				\
+		}																					\
+	}																						\
+} while (0)
+
+/**
+* @brief		returns the number of keys in a set
+*
+* @param[in]	set - the set you're querying the size of
+*/
+#define HSET_SIZE(set) ((set) ? (set)->count : 0)
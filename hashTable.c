@@ -10,16 +10,45 @@
 #include <assert.h> 
 #include <stdbool.h>
 #include <string.h>
+#include <time.h>
 
 
 //---------------------------------------------------------
 // Private Consts:
 //---------------------------------------------------------
 
+// hint the cpu to start loading addr into cache
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define PREFETCH(addr) _mm_prefetch((const char *)(addr), _MM_HINT_T0)
+#else
+#define PREFETCH(addr) ((void)(addr))
+#endif
+
+// values stored inside an entry start on a multiple of this, enough for any built in type
+#define HASH_VALUE_ALIGN 16
+
 //---------------------------------------------------------
 // Private Structures:
 //---------------------------------------------------------
 
+// the front of every entry's single allocation. the value follows at HASH_VALUE_OFFSET
+typedef struct {
+	sl_node node;				// link in the bucket list. node.data points at item
+	_HashItem item;				// key info. item.data points at the value
+} _HashEntry;
+
+// what an entry removed from an epoch table needs to be freed into the table's allocator
+typedef struct {
+	_HashEntry *entry;			// the unlinked entry
+	Allocator *allocator;		// the allocator the entry came from
+	void(*free_func)(void *);	// called on the value
+} _HashRetired;
+
+#define HASH_VALUE_OFFSET ((sizeof(_HashEntry) + HASH_VALUE_ALIGN - 1) / HASH_VALUE_ALIGN * HASH_VALUE_ALIGN)
+
 //---------------------------------------------------------
 // Public Variables:
 //---------------------------------------------------------
@@ -32,199 +61,1205 @@
 // Private Function Declarations:
 //---------------------------------------------------------
 static unsigned default_hash(unsigned char *string);
+static unsigned default_hash_bin(unsigned char *key, int key_len);
+static unsigned _hash_key(HashTable *hash_table, unsigned char *key, int key_len);
+static bool _hash_store_key(HashTable *hash_table, _HashItem *item, unsigned char *key, int key_len);
+static LinkedList **_hash_snapshot(HashTable *hash_table, int *table_size);
+static sl_node *_hash_lookup(HashTable *hash_table, unsigned char *key, int key_len, unsigned hash);
+static int _hash_remove(HashTable *hash_table, unsigned char *key, int key_len, void(free_func)(void *), bool all);
+static void _bucket_insert_after(LinkedList *bucket, sl_node *prev, sl_node *node);
+static void _hash_find_batch(HashTable *hash_table, unsigned char **keys, int *key_lens, int n, void **out);
+static void _hash_copy_bucket(HashTable *new_table, LinkedList *bucket, void *(copy_func)(void *), int size);
+static void _bucket_append_node(LinkedList *bucket, sl_node *node);
+static LinkedList **_hash_new_buckets(HashTable *hash_table, int table_size);
+static void _hash_alloc_buckets(HashTable *hash_table, int table_size);
+static void _hash_migrate_bucket(HashTable *hash_table, LinkedList *old_bucket);
+static void _hash_rehash_step(HashTable *hash_table, int steps);
+static void _hash_resize(HashTable *hash_table, int table_size);
+static void _hash_resize_copy(HashTable *hash_table, int table_size);
+static int _hash_size_for(int capacity);
+static void _hash_compact_keys(HashTable *hash_table);
+static void _hash_rebuild_filter(HashTable *hash_table, int capacity, double fp_rate);
+static void *_hash_place(HashTable *hash_table, unsigned char *key, int key_len, unsigned hash, void *val, int value_size);
+static void _hash_free_bucket(LinkedList *bucket, void(free_func)(void *));
+static void _hash_retire(HashTable *hash_table, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *));
+static void _hash_retire_entry(HashTable *hash_table, sl_node *node, void(free_func)(void *));
+static void _hash_reclaim_alloc_entry(void *retired, void(free_func)(void *));
+static void _hash_reclaim_arena(void *arena, void(free_func)(void *));
+static void _hash_reclaim_table(void *hash_table, void(free_func)(void *));
+static void _hash_reclaim_entry(void *entry, void(free_func)(void *));
+static void _hash_reclaim_value(void *value, void(free_func)(void *));
+static void _hash_reclaim_buckets(void *buckets, void(free_func)(void *));
+static void _hash_reclaim_filter(void *filter, void(free_func)(void *));
+static double _hash_now(void);
+static void _hash_stats_probe(HashStats *stats, int probes, bool hit);
+static void _hash_stats_grow(HashStats *stats, double start);
+static void _hash_timed_rehash_step(HashTable *hash_table, int steps);
 
 //---------------------------------------------------------
 // Public Functions:
 //---------------------------------------------------------
 
 HashTable *hash_create(unsigned(hash_func)(unsigned char *)) {
-	HashTable *new_table = malloc(sizeof(HashTable));
+	return hash_create_ex(hash_func, HASH_DEFAULT);
+}
+
+HashTable *hash_create_ex(unsigned(hash_func)(unsigned char *), int flags) {
+	return hash_create_with_capacity(hash_func, 0, flags);
+}
+
+HashTable *hash_create_with_capacity(unsigned(hash_func)(unsigned char *), int capacity, int flags) {
+	return hash_create_alloc(hash_func, capacity, flags, NULL);
+}
+
+HashTable *hash_create_alloc(unsigned(hash_func)(unsigned char *), int capacity, int flags, Allocator *allocator) {
+	Counters *counters = COUNTERS_CREATE("HashTable", allocator);
+	allocator = COUNTERS_ALLOCATOR(counters, allocator);
+	HashTable *new_table = alloc_malloc(allocator, sizeof(HashTable));
+	if (!new_table) {
+		printf("failed to allocate hash table");
+		COUNTERS_FREE(counters);
+		return NULL;
+	}
+	new_table->allocator = allocator;
+	new_table->counters = counters;
 	if (hash_func) {
 		new_table->hash_func = hash_func;
+		new_table->hash_bin_func = NULL;
 	}
 	else {
 		new_table->hash_func = default_hash;
+		new_table->hash_bin_func = default_hash_bin;
 	}
+	new_table->key_arena = NULL;
 	new_table->count = 0;
-	new_table->table_size = 4;
-	new_table->used_buckets = 0;
-	new_table->buckets = malloc(new_table->table_size * sizeof(LinkedList *));
-	for (int i = 0; i < new_table->table_size; i++) {
-		new_table->buckets[i] = link_create(SINGLY_LINKED_LIST);
+	new_table->flags = flags;
+	new_table->old_buckets = NULL;
+	new_table->old_table_size = 0;
+	new_table->rehash_pos = 0;
+	new_table->stats = NULL;
+	new_table->value_size = 0;
+	new_table->shrink_load = HASH_SHRINK_LOAD;
+	new_table->filter = NULL;
+	new_table->filter_stale = 0;
+	new_table->epoch = NULL;
+	new_table->resize_seq = 0;
+	if (flags & HASH_STATS) {
+		new_table->stats = alloc_malloc(allocator, sizeof(HashStats));
+		if (!new_table->stats) {
+			printf("failed to allocate hash table stats");
+		}
+		else {
+			memset(new_table->stats, 0, sizeof(HashStats));
+			new_table->stats->bytes_allocated = sizeof(HashTable) + sizeof(HashStats);
+		}
+	}
+	_hash_alloc_buckets(new_table, _hash_size_for(capacity));
+	return new_table;
+}
+
+HashTable *hash_create_bin(unsigned(hash_func)(unsigned char *, int), int flags) {
+	HashTable *new_table = hash_create_ex(NULL, flags);
+	if (hash_func) {
+		new_table->hash_bin_func = hash_func;
 	}
 	return new_table;
 }
 
+HashTable *hash_create_sized(unsigned(hash_func)(unsigned char *), int value_size, int flags) {
+	HashTable *new_table = hash_create_ex(hash_func, flags);
+	new_table->value_size = value_size;
+	return new_table;
+}
+
 HashTable *hash_copy(HashTable *hash_table, void *(copy_func)(void *), int size_t) {
-    HashTable *new_table = hash_create(hash_table->hash_func);
+    COUNTERS_OP(hash_table->counters, COUNTERS_COPY);
+    HashTable *new_table = hash_create_alloc(hash_table->hash_func, hash_table->count, hash_table->flags, counters_unwrap(hash_table->allocator));
+    new_table->hash_bin_func = hash_table->hash_bin_func;
+    new_table->value_size = hash_table->value_size;
+    new_table->shrink_load = hash_table->shrink_load;
+    if (hash_table->filter) {
+        hash_set_filter(new_table, hash_table->filter->fp_rate);
+    }
+    if (size_t <= 0) {
+        // a table not made with hash_create_sized has no value_size, but copies are pointers
+        size_t = hash_table->value_size > 0 ? hash_table->value_size : (int)sizeof(void *);
+    }
     for (int i = 0; i < hash_table->table_size; i++) {
-        LINK_FOREACH(_HashItem, item, hash_table->buckets[i],
-            if (copy_func) {
-                void *copied_item = copy_func(*(void **)item.data);
-                HASH_ADD_SIZE(size_t, new_table, copied_item, item.key);
-            }
-            else {
-                HASH_ADD_SIZE(size_t, new_table, item.data, item.key);
-            }
-        );
+        _hash_copy_bucket(new_table, hash_table->buckets[i], copy_func, size_t);
+    }
+    for (int i = hash_table->rehash_pos; hash_table->old_buckets && i < hash_table->old_table_size; i++) {
+        _hash_copy_bucket(new_table, hash_table->old_buckets[i], copy_func, size_t);
     }
     return new_table;
 }
 
 void hash_free(HashTable *hash_table, void(free_func)(void *)) {
+	if (!free_func && alloc_is_region(hash_table->allocator)) {
+		// nothing in the table needs visiting, the region releases it a block at a time when it
+		// is dropped. only the filter comes from malloc
+		arena_free(hash_table->key_arena);
+		bloom_free(hash_table->filter);
+		COUNTERS_FREE(hash_table->counters);
+		return;
+	}
+	Counters *counters = hash_table->counters;
 	for (int i = 0; i < hash_table->table_size; i++) {
-		if (LINK_SIZE(hash_table->buckets[i])) {
-			sl_node *s = hash_table->buckets[i]->head;
-			while (s->next) {
-                if (s->data) {
-                    _HashItem item = (*(_HashItem *)(s->data));
-                    if (free_func && item.data) {
-                        (*free_func)(*(void **)item.data);
-                        (*(void **)item.data) = NULL;
-                    }
-                    free(item.data);
-                    item.data = NULL;
-                }
-				free(s->data);
-				s->data = NULL;
-				sl_node *temp = s;
-				s = s->next;
-				free(temp);
-				temp = NULL;
-			}
-			if (s->data) {
-				_HashItem item = (*(_HashItem *)(s->data));
-                if (free_func && item.data) {
-                    (*free_func)(*(void **)item.data);
-                    (*(void **)item.data) = NULL;
-                }
-                free(item.data);
-				item.data = NULL;
-			}
-			free(s->data);
-			s->data = NULL;
-			free(s);
-			s = NULL;
-		}
-		free(hash_table->buckets[i]);
+		_hash_free_bucket(hash_table->buckets[i], free_func);
 		hash_table->buckets[i] = NULL;
 	}
-	free(hash_table->buckets);
+	alloc_free(hash_table->allocator, hash_table->buckets);
 	hash_table->buckets = NULL;
-	free(hash_table);
+	if (hash_table->old_buckets) {
+		for (int i = hash_table->rehash_pos; i < hash_table->old_table_size; i++) {
+			_hash_free_bucket(hash_table->old_buckets[i], free_func);
+		}
+		alloc_free(hash_table->allocator, hash_table->old_buckets);
+		hash_table->old_buckets = NULL;
+	}
+	// owned keys are released a block at a time
+	arena_free(hash_table->key_arena);
+	bloom_free(hash_table->filter);
+	alloc_free(hash_table->allocator, hash_table->stats);
+	alloc_free(hash_table->allocator, hash_table);
+	COUNTERS_FREE(counters);
+}
+
+void hash_free_async(HashTable *hash_table, void(free_func)(void *), Reclaimer *reclaimer) {
+	if (!free_func && alloc_is_region(hash_table->allocator)) {
+		// a region table is freed without visiting anything, so there is no work to hand over
+		hash_free(hash_table, NULL);
+		return;
+	}
+	reclaimer_retire(reclaimer, hash_table, _hash_reclaim_table, free_func);
+}
+
+void hash_reserve(HashTable *hash_table, int capacity) {
+	int table_size = _hash_size_for(capacity);
+	if (table_size > hash_table->table_size) {
+		_hash_resize(hash_table, table_size);
+	}
+}
+
+void hash_set_shrink_load(HashTable *hash_table, float low_water) {
+	assert(low_water >= 0 && low_water < 0.35f);
+	hash_table->shrink_load = low_water;
+}
+
+void hash_compact(HashTable *hash_table) {
+	if (hash_table->old_buckets) {
+		_hash_timed_rehash_step(hash_table, hash_table->old_table_size);
+	}
+	int table_size = _hash_size_for(hash_table->count);
+	if (table_size < hash_table->table_size) {
+		_hash_resize(hash_table, table_size);
+		// compacting is explicit, so it doesn't leave anything for later removes to migrate
+		if (hash_table->old_buckets) {
+			_hash_timed_rehash_step(hash_table, hash_table->old_table_size);
+		}
+	}
+	if (hash_table->key_arena) {
+		_hash_compact_keys(hash_table);
+	}
+	if (hash_table->filter && hash_table->filter_stale) {
+		_hash_rebuild_filter(hash_table, hash_table->count, hash_table->filter->fp_rate);
+	}
+}
+
+void hash_set_filter(HashTable *hash_table, double fp_rate) {
+	if (fp_rate <= 0) {
+		BloomFilter *filter = hash_table->filter;
+		__EPOCH_STORE_PTR(&hash_table->filter, NULL);
+		if (filter) {
+			_hash_retire(hash_table, filter, _hash_reclaim_filter, NULL);
+		}
+		return;
+	}
+	// sized for everything the current bucket array holds before growing
+	int capacity = (int)(hash_table->table_size * 0.69);
+	if (capacity < hash_table->count) capacity = hash_table->count;
+	// incremental grows don't rebuild the filter, so leave it room for the next one
+	if (hash_table->flags & HASH_INCREMENTAL) capacity *= 2;
+	_hash_rebuild_filter(hash_table, capacity, fp_rate);
+}
+
+void hash_bulk_load(HashTable *hash_table, unsigned char **keys, void *values, int n) {
+	assert(hash_table->value_size > 0);
+	hash_reserve(hash_table, hash_table->count + n);
+	// entries are placed straight into the final array, so any migration has to be done first
+	if (hash_table->old_buckets) {
+		_hash_timed_rehash_step(hash_table, hash_table->old_table_size);
+	}
+	unsigned hashes[HASH_BULK_CHUNK];
+	int lens[HASH_BULK_CHUNK];
+	for (int i = 0; i < n; i += HASH_BULK_CHUNK) {
+		int chunk = n - i < HASH_BULK_CHUNK ? n - i : HASH_BULK_CHUNK;
+		for (int j = 0; j < chunk; j++) {
+			lens[j] = (int)strlen((const char *)keys[i + j]);
+			hashes[j] = _hash_key(hash_table, keys[i + j], lens[j]);
+			PREFETCH(hash_table->buckets[hashes[j] % hash_table->table_size]);
+		}
+		for (int j = 0; j < chunk; j++) {
+			void *value = (unsigned char *)values + (size_t)(i + j) * hash_table->value_size;
+			_hash_place(hash_table, keys[i + j], lens[j], hashes[j], value, hash_table->value_size);
+		}
+	}
+}
+
+void hash_set_epoch(HashTable *hash_table, Epoch *epoch) {
+	// readers can't follow an incremental grow, so one in progress is finished first
+	if (hash_table->old_buckets) {
+		_hash_timed_rehash_step(hash_table, hash_table->old_table_size);
+	}
+	hash_table->epoch = epoch;
 }
 
 bool hash_exists(HashTable *hash_table, unsigned char *key) {
-	unsigned int hash = (*hash_table->hash_func)(key);
-	unsigned int index = hash % hash_table->table_size;
-	LINK_FOREACH(_HashItem, item, hash_table->buckets[index],
-		if (strcmp(item.key, key) == 0) {
-			return true;
+	return hash_exists_bin(hash_table, key, (int)strlen((const char *)key));
+}
+
+void hash_stats(HashTable *hash_table, HashStats *out) {
+	memset(out, 0, sizeof(HashStats));
+	if (hash_table->stats) {
+		*out = *hash_table->stats;
+		memset(out->chain_histogram, 0, sizeof(out->chain_histogram));
+	}
+	// while growing incrementally, unmigrated buckets of the old array still hold entries
+	for (int i = 0; i < hash_table->table_size; i++) {
+		int size = LINK_SIZE(hash_table->buckets[i]);
+		out->chain_histogram[size < HASH_STATS_HISTOGRAM ? size : HASH_STATS_HISTOGRAM - 1]++;
+	}
+	for (int i = hash_table->rehash_pos; hash_table->old_buckets && i < hash_table->old_table_size; i++) {
+		int size = LINK_SIZE(hash_table->old_buckets[i]);
+		out->chain_histogram[size < HASH_STATS_HISTOGRAM ? size : HASH_STATS_HISTOGRAM - 1]++;
+	}
+}
+
+void hash_stats_reset(HashTable *hash_table) {
+	if (hash_table->stats) {
+		long long bytes_allocated = hash_table->stats->bytes_allocated;
+		memset(hash_table->stats, 0, sizeof(HashStats));
+		hash_table->stats->bytes_allocated = bytes_allocated;
+	}
+}
+
+void hash_stats_dump_json(HashTable *hash_table, FILE *out) {
+	HashStats stats;
+	hash_stats(hash_table, &stats);
+	long long hits = stats.lookups - stats.misses;
+	fprintf(out, "{\n");
+	fprintf(out, "  \"count\": %d,\n", hash_table->count);
+	fprintf(out, "  \"table_size\": %d,\n", hash_table->table_size);
+	fprintf(out, "  \"used_buckets\": %d,\n", hash_table->used_buckets);
+	fprintf(out, "  \"lookups\": %lld,\n", stats.lookups);
+	fprintf(out, "  \"avg_probes\": %.3f,\n", hits ? (double)(stats.lookup_probes - stats.miss_probes) / hits : 0.0);
+	fprintf(out, "  \"max_probes\": %d,\n", stats.max_probes);
+	fprintf(out, "  \"misses\": %lld,\n", stats.misses);
+	fprintf(out, "  \"avg_miss_probes\": %.3f,\n", stats.misses ? (double)stats.miss_probes / stats.misses : 0.0);
+	fprintf(out, "  \"max_miss_probes\": %d,\n", stats.max_miss_probes);
+	fprintf(out, "  \"key_compares\": %lld,\n", stats.key_compares);
+	fprintf(out, "  \"filter_rejects\": %lld,\n", stats.filter_rejects);
+	fprintf(out, "  \"grows\": %d,\n", stats.grows);
+	fprintf(out, "  \"shrinks\": %d,\n", stats.shrinks);
+	fprintf(out, "  \"grow_seconds\": %.9f,\n", stats.grow_seconds);
+	fprintf(out, "  \"max_grow_seconds\": %.9f,\n", stats.max_grow_seconds);
+	fprintf(out, "  \"bytes_allocated\": %lld,\n", stats.bytes_allocated);
+	fprintf(out, "  \"chain_histogram\": [");
+	for (int i = 0; i < HASH_STATS_HISTOGRAM; i++) {
+		fprintf(out, i ? ", %d" : "%d", stats.chain_histogram[i]);
+	}
+	fprintf(out, "]\n}\n");
+}
+
+bool hash_exists_bin(HashTable *hash_table, unsigned char *key, int key_len) {
+	unsigned int hash = _hash_key(hash_table, key, key_len);
+	return _hash_lookup(hash_table, key, key_len, hash) != NULL;
+}
+
+void hash_find_many(HashTable *hash_table, unsigned char **keys, int n, void **out) {
+	for (int i = 0; i < n; i += HASH_BATCH_SIZE) {
+		int batch = n - i < HASH_BATCH_SIZE ? n - i : HASH_BATCH_SIZE;
+		_hash_find_batch(hash_table, keys + i, NULL, batch, out + i);
+	}
+}
+
+void hash_exists_many(HashTable *hash_table, unsigned char **keys, int n, bool *out) {
+	void *found[HASH_BATCH_SIZE];
+	for (int i = 0; i < n; i += HASH_BATCH_SIZE) {
+		int batch = n - i < HASH_BATCH_SIZE ? n - i : HASH_BATCH_SIZE;
+		_hash_find_batch(hash_table, keys + i, NULL, batch, found);
+		for (int j = 0; j < batch; j++) {
+			out[i + j] = found[j] != NULL;
 		}
-	);
-	return false;
+	}
+}
+
+void hash_find_many_bin(HashTable *hash_table, unsigned char **keys, int *key_lens, int n, void **out) {
+	for (int i = 0; i < n; i += HASH_BATCH_SIZE) {
+		int batch = n - i < HASH_BATCH_SIZE ? n - i : HASH_BATCH_SIZE;
+		_hash_find_batch(hash_table, keys + i, key_lens + i, batch, out + i);
+	}
 }
 
-// macro helper functions
 void hash_rem(HashTable *hash_table, unsigned char *key, void(free_func)(void *)) {
-	void *free_me = NULL;
-	unsigned int hash = (*hash_table->hash_func)(key);
+	hash_rem_bin(hash_table, key, (int)strlen((const char *)key), free_func);
+}
+
+// macro helper functions
+void hash_rem_bin(HashTable *hash_table, unsigned char *key, int key_len, void(free_func)(void *)) {
+	_hash_remove(hash_table, key, key_len, free_func, false);
+}
+
+int hash_rem_all(HashTable *hash_table, unsigned char *key, void(free_func)(void *)) {
+	return _hash_remove(hash_table, key, (int)strlen((const char *)key), free_func, true);
+}
+
+int hash_rem_all_bin(HashTable *hash_table, unsigned char *key, int key_len, void(free_func)(void *)) {
+	return _hash_remove(hash_table, key, key_len, free_func, true);
+}
+
+HashIter hash_find_all(HashTable *hash_table, unsigned char *key) {
+	return hash_find_all_bin(hash_table, key, (int)strlen((const char *)key));
+}
+
+HashIter hash_find_all_bin(HashTable *hash_table, unsigned char *key, int key_len) {
+	HashIter iter;
+	iter.key = key;
+	iter.key_len = key_len;
+	iter.hash = _hash_key(hash_table, key, key_len);
+	iter.node = _hash_lookup(hash_table, key, key_len, iter.hash);
+	iter.grouped = (hash_table->flags & HASH_MULTI) != 0;
+	iter.found = false;
+	return iter;
+}
+
+void *hash_iter_next(HashIter *iter) {
+	while (iter->node) {
+		_HashItem *item = iter->node->data;
+		iter->node = __EPOCH_LOAD_PTR(&iter->node->next);
+		if (item->hash == iter->hash && item->key_len == iter->key_len &&
+			memcmp(__EPOCH_LOAD_PTR(&item->key), iter->key, iter->key_len) == 0) {
+			iter->found = true;
+			return item->data;
+		}
+		// with HASH_MULTI every match sits in one run, so the first miss after it ends the search
+		if (iter->grouped && iter->found) {
+			iter->node = NULL;
+		}
+	}
+	return NULL;
+}
+
+int hash_count_key(HashTable *hash_table, unsigned char *key) {
+	return hash_count_key_bin(hash_table, key, (int)strlen((const char *)key));
+}
+
+int hash_count_key_bin(HashTable *hash_table, unsigned char *key, int key_len) {
+	HashIter iter = hash_find_all_bin(hash_table, key, key_len);
+	int count = 0;
+	while (hash_iter_next(&iter)) {
+		count++;
+	}
+	return count;
+}
+
+void *__hash_add(HashTable *hash_table, unsigned char *key, void *val, int value_size) {
+	return __hash_add_bin(hash_table, key, (int)strlen((const char *)key), val, value_size);
+}
+
+void *__hash_add_bin(HashTable *hash_table, unsigned char *key, int key_len, void *val, int value_size) {
+	unsigned int hash = _hash_key(hash_table, key, key_len);
+	if (hash_table->old_buckets) {
+		_hash_timed_rehash_step(hash_table, HASH_REHASH_STEP);
+	}
+	if (!hash_table->old_buckets) {
+		float loadFactor = (float)hash_table->used_buckets / hash_table->table_size;
+		if (loadFactor >= 0.5f) __hash_grow(hash_table);
+	}
+	if (hash_table->old_buckets) {
+		// move the key's old bucket over first (including right after the grow above), so lookups,
+		// which only read the old bucket while it has entries, still find the new key, and entries
+		// sharing a key stay in one run in insertion order
+		int old_index = hash % hash_table->old_table_size;
+		if (old_index >= hash_table->rehash_pos) {
+			_hash_migrate_bucket(hash_table, hash_table->old_buckets[old_index]);
+		}
+	}
+	return _hash_place(hash_table, key, key_len, hash, val, value_size);
+}
+
+void __hash_grow(HashTable *hash_table) {
+	_hash_resize(hash_table, hash_table->table_size * 2);
+}
+
+void* __hash_find(HashTable *hash_table, unsigned char *key) {
+	return __hash_find_bin(hash_table, key, (int)strlen((const char *)key));
+}
+
+void* __hash_find_bin(HashTable *hash_table, unsigned char *key, int key_len) {
+	unsigned int hash = _hash_key(hash_table, key, key_len);
+	sl_node *node = _hash_lookup(hash_table, key, key_len, hash);
+	return node ? ((_HashItem *)node->data)->data : NULL;
+}
+
+// data is the stored value, which is handed to free_func the same way hash_rem does
+void __attempt_freefunc_call(HashTable *hash_table, void(free_func)(void *), void *data) {
+	COUNTERS_OP(hash_table->counters, COUNTERS_REPLACE);
+	if (free_func && data) {
+		_hash_retire(hash_table, *(void **)data, _hash_reclaim_value, free_func);
+	}
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// hashes a key with the table's length aware hash, falling back to the string hash
+static unsigned _hash_key(HashTable *hash_table, unsigned char *key, int key_len) {
+	if (hash_table->hash_bin_func) {
+		return (*hash_table->hash_bin_func)(key, key_len);
+	}
+	return (*hash_table->hash_func)(key);
+}
+
+// points item at its key. owned keys are copied inline when short, otherwise into
+// the key arena. copies are always '\0' terminated so they still work as strings.
+// returns false, leaving item->key alone, if the copy couldn't be allocated
+static bool _hash_store_key(HashTable *hash_table, _HashItem *item, unsigned char *key, int key_len) {
+	if (!(hash_table->flags & HASH_OWN_KEYS)) {
+		item->key = key;
+		return true;
+	}
+	unsigned char *copy;
+	if (key_len <= HASH_INLINE_KEY_SIZE) {
+		copy = item->inline_key;
+	}
+	else {
+		if (!hash_table->key_arena) {
+			hash_table->key_arena = arena_create(HASH_KEY_ARENA_BLOCK, hash_table->allocator);
+			if (!hash_table->key_arena) {
+				return false;
+			}
+		}
+		size_t reserved = hash_table->key_arena->bytes_reserved;
+		copy = alloc_malloc(arena_allocator(hash_table->key_arena), key_len + 1);
+		if (!copy) {
+			printf("failed to allocate hash table key arena");
+			return false;
+		}
+		if (hash_table->stats) {
+			hash_table->stats->bytes_allocated += hash_table->key_arena->bytes_reserved - reserved;
+		}
+	}
+	memcpy(copy, key, key_len);
+	copy[key_len] = '\0';
+	__EPOCH_STORE_PTR(&item->key, copy);
+	return true;
+}
+
+// finds the node of the first item matching key. the cached hash and length are compared
+// first so memcmp only runs on a probable match
+static sl_node *_hash_lookup(HashTable *hash_table, unsigned char *key, int key_len, unsigned hash) {
+	COUNTERS_OP(hash_table->counters, COUNTERS_FIND);
+	BloomFilter *filter = __EPOCH_LOAD_PTR(&hash_table->filter);
+	if (filter && !bloom_maybe_contains_hash(filter, hash)) {
+		if (hash_table->stats) {
+			hash_table->stats->filter_rejects++;
+			_hash_stats_probe(hash_table->stats, 0, false);
+		}
+		return NULL;
+	}
+	int table_size;
+	LinkedList **buckets = _hash_snapshot(hash_table, &table_size);
+	sl_node *node = __EPOCH_LOAD_PTR(&buckets[hash % table_size]->head);
+	if (hash_table->old_buckets) {
+		// while growing incrementally, unmigrated keys are still in the old array
+		int old_index = hash % hash_table->old_table_size;
+		if (old_index >= hash_table->rehash_pos && hash_table->old_buckets[old_index]->size) {
+			node = hash_table->old_buckets[old_index]->head;
+		}
+	}
+	if (hash_table->stats) {
+		// counting is kept out of the loop below so tables without HASH_STATS don't pay for it
+		int probes = 0;
+		while (node) {
+			_HashItem *item = node->data;
+			probes++;
+			if (item->hash == hash && item->key_len == key_len) {
+				hash_table->stats->key_compares++;
+				if (memcmp(__EPOCH_LOAD_PTR(&item->key), key, key_len) == 0) break;
+			}
+			node = __EPOCH_LOAD_PTR(&node->next);
+		}
+		_hash_stats_probe(hash_table->stats, probes, node != NULL);
+		return node;
+	}
+	while (node) {
+		_HashItem *item = node->data;
+		if (item->hash == hash && item->key_len == key_len && memcmp(__EPOCH_LOAD_PTR(&item->key), key, key_len) == 0) {
+			return node;
+		}
+		node = __EPOCH_LOAD_PTR(&node->next);
+	}
+	return NULL;
+}
+
+// reads the bucket array and its size. epoch readers can race a resize swapping both,
+// so they retry until they read a matching pair
+static LinkedList **_hash_snapshot(HashTable *hash_table, int *table_size) {
+	if (!hash_table->epoch) {
+		*table_size = hash_table->table_size;
+		return hash_table->buckets;
+	}
+	for (;;) {
+		int seq = __EPOCH_LOAD_INT(&hash_table->resize_seq);
+		LinkedList **buckets = __EPOCH_LOAD_PTR(&hash_table->buckets);
+		*table_size = __EPOCH_LOAD_INT(&hash_table->table_size);
+		if (!(seq & 1) && __EPOCH_LOAD_INT(&hash_table->resize_seq) == seq) {
+			return buckets;
+		}
+	}
+}
+
+// appends an existing node to the back of a bucket without allocating
+static void _bucket_append_node(LinkedList *bucket, sl_node *node) {
+	node->next = NULL;
+	// linking is the last store, so an epoch reader that reaches the node sees all of it
+	if (bucket->size == 0) {
+		__EPOCH_STORE_PTR(&bucket->head, node);
+	}
+	else {
+		__EPOCH_STORE_PTR(&((sl_node *)bucket->tail)->next, node);
+	}
+	bucket->tail = node;
+	bucket->size++;
+}
+
+// links an existing node into a bucket right after prev without allocating
+static void _bucket_insert_after(LinkedList *bucket, sl_node *prev, sl_node *node) {
+	node->next = prev->next;
+	__EPOCH_STORE_PTR(&prev->next, node);
+	if (bucket->tail == prev) {
+		bucket->tail = node;
+	}
+	bucket->size++;
+}
+
+// allocates an array of table_size empty buckets. a NULL after the last one marks the
+// end, so a retired array can be freed without knowing its size
+static LinkedList **_hash_new_buckets(HashTable *hash_table, int table_size) {
+	LinkedList **buckets = alloc_malloc(hash_table->allocator, (table_size + 1) * sizeof(LinkedList *));
+	if (!buckets) {
+		printf("failed to allocate hash table buckets");
+		return NULL;
+	}
+	for (int i = 0; i < table_size; i++) {
+		buckets[i] = link_create_alloc(SINGLY_LINKED_LIST, hash_table->allocator);
+	}
+	buckets[table_size] = NULL;
+	if (hash_table->stats) {
+		hash_table->stats->bytes_allocated += (long long)table_size * (sizeof(LinkedList *) + sizeof(LinkedList));
+	}
+	return buckets;
+}
+
+// allocates an empty bucket array of the given size as the table's current array
+static void _hash_alloc_buckets(HashTable *hash_table, int table_size) {
+	hash_table->table_size = table_size;
+	hash_table->used_buckets = 0;
+	hash_table->buckets = _hash_new_buckets(hash_table, table_size);
+}
+
+// relinks every node of an old bucket into the current bucket array, leaving it empty
+static void _hash_migrate_bucket(HashTable *hash_table, LinkedList *old_bucket) {
+	sl_node *node = old_bucket->head;
+	while (node) {
+		sl_node *next = node->next;
+		unsigned int index = ((_HashItem *)node->data)->hash % hash_table->table_size;
+		if (LINK_SIZE(hash_table->buckets[index]) == 0)
+			hash_table->used_buckets++;
+		_bucket_append_node(hash_table->buckets[index], node);
+		node = next;
+	}
+	old_bucket->head = NULL;
+	old_bucket->tail = NULL;
+	old_bucket->size = 0;
+}
+
+// migrates up to steps old buckets, releasing the old array once it is empty
+static void _hash_rehash_step(HashTable *hash_table, int steps) {
+	while (steps-- > 0 && hash_table->rehash_pos < hash_table->old_table_size) {
+		LinkedList *old_bucket = hash_table->old_buckets[hash_table->rehash_pos];
+		_hash_migrate_bucket(hash_table, old_bucket);
+		alloc_free(hash_table->allocator, old_bucket);
+		hash_table->old_buckets[hash_table->rehash_pos] = NULL;
+		hash_table->rehash_pos++;
+		if (hash_table->stats) {
+			hash_table->stats->bytes_allocated -= sizeof(LinkedList);
+		}
+	}
+	if (hash_table->rehash_pos >= hash_table->old_table_size) {
+		if (hash_table->stats) {
+			hash_table->stats->bytes_allocated -= (long long)hash_table->old_table_size * sizeof(LinkedList *);
+		}
+		alloc_free(hash_table->allocator, hash_table->old_buckets);
+		hash_table->old_buckets = NULL;
+		hash_table->old_table_size = 0;
+		hash_table->rehash_pos = 0;
+	}
+}
+
+// removes the first entry matching key, or every one of them when all is set. returns how many were removed
+static int _hash_remove(HashTable *hash_table, unsigned char *key, int key_len, void(free_func)(void *), bool all) {
+	COUNTERS_OP(hash_table->counters, COUNTERS_REMOVE);
+	unsigned int hash = _hash_key(hash_table, key, key_len);
+	if (hash_table->filter && !bloom_maybe_contains_hash(hash_table->filter, hash)) {
+		if (hash_table->stats) {
+			hash_table->stats->filter_rejects++;
+			_hash_stats_probe(hash_table->stats, 0, false);
+		}
+		return 0;
+	}
+	if (hash_table->old_buckets) {
+		_hash_timed_rehash_step(hash_table, HASH_REHASH_STEP);
+	}
+	if (hash_table->old_buckets) {
+		// the key's entries are either all still in its old bucket or all in the new array
+		int old_index = hash % hash_table->old_table_size;
+		if (old_index >= hash_table->rehash_pos) {
+			_hash_migrate_bucket(hash_table, hash_table->old_buckets[old_index]);
+		}
+	}
 	unsigned int index = hash % hash_table->table_size;
 	LinkedList *list = hash_table->buckets[index];
-	if (list->size == 1) {
-		sl_node *node = list->head;
-		free_me = (*(_HashItem *)node->data).data;
-		link_rem_front(list, NULL);
+	sl_node *prev = NULL;
+	sl_node *node = list->head;
+	int probes = 0;
+	int removed = 0;
+	while (node) {
+		_HashItem *item = node->data;
+		sl_node *next = node->next;
+		probes++;
+		bool match = false;
+		if (item->hash == hash && item->key_len == key_len) {
+			if (hash_table->stats) hash_table->stats->key_compares++;
+			match = memcmp(item->key, key, key_len) == 0;
+		}
+		if (!match) {
+			prev = node;
+			node = next;
+			continue;
+		}
+
+		//unlink the node, keeping head and tail valid. an epoch reader standing on it can still move on
+		if (prev) {
+			__EPOCH_STORE_PTR(&prev->next, next);
+		}
+		else {
+			__EPOCH_STORE_PTR(&list->head, next);
+		}
+		if (list->tail == node) {
+			list->tail = prev;
+		}
+		list->size--;
 		hash_table->count--;
+
+		if (hash_table->stats) {
+			hash_table->stats->bytes_allocated -= HASH_VALUE_OFFSET + item->value_size;
+		}
+		_hash_retire_entry(hash_table, node, free_func);
+		removed++;
+		if (!all) {
+			break;
+		}
+		node = next;
+	}
+	if (hash_table->stats) {
+		_hash_stats_probe(hash_table->stats, probes, removed > 0);
+	}
+	if (!removed) {
+		return 0;
+	}
+	if (list->size == 0) {
 		hash_table->used_buckets--;
 	}
-	else if (list->size > 1) {
-		sl_node *node = list->head;
-		_HashItem item;
-		//search through full list
-		while (node->next != list->tail) {
-			item = *(_HashItem *)node->next->data;
-			if (strcmp(item.key, key) == 0) {
-				break;
-			}
-            node = node->next;
+
+	// the filter can't forget keys, so it is rebuilt once it mostly remembers removed ones
+	if (hash_table->filter && (hash_table->filter_stale += removed) > hash_table->count) {
+		_hash_rebuild_filter(hash_table, hash_table->filter->capacity, hash_table->filter->fp_rate);
+	}
+
+	// shrinking waits for any grow in progress to finish
+	if (!hash_table->old_buckets && hash_table->table_size > 4 &&
+		hash_table->count < hash_table->table_size * hash_table->shrink_load) {
+		_hash_resize(hash_table, _hash_size_for(hash_table->count));
+	}
+	return removed;
+}
+
+// points the table at a new bucket array of table_size buckets and moves every entry over,
+// or only starts moving them with HASH_INCREMENTAL
+static void _hash_resize(HashTable *hash_table, int table_size) {
+	double start = hash_table->stats ? _hash_now() : 0;
+	bool growing = table_size > hash_table->table_size;
+	COUNTERS_RESIZE(hash_table->counters);
+	if (hash_table->epoch) {
+		_hash_resize_copy(hash_table, table_size);
+	}
+	else {
+		// a grow that is still in progress has to finish before the next one starts
+		if (hash_table->old_buckets) {
+			_hash_rehash_step(hash_table, hash_table->old_table_size);
 		}
-		//at this point, item has the correct data, or the correct data doesn't exist.
-		if (strcmp(item.key, key) == 0) {
-			free_me = item.data;
+		hash_table->old_table_size = hash_table->table_size;
+		hash_table->old_buckets = hash_table->buckets;
+		hash_table->rehash_pos = 0;
+		_hash_alloc_buckets(hash_table, table_size);
 
-			sl_node *temp = node->next;
-			node->next = node->next->next;
-			free(temp);
-			temp = NULL;
-			list->size--;
-			hash_table->count--;
+		/* move every node into its new bucket using the hash cached in its item.
+		 * nodes are relinked rather than copied, so nothing is rehashed or reallocated */
+		if (!(hash_table->flags & HASH_INCREMENTAL)) {
+			_hash_rehash_step(hash_table, hash_table->old_table_size);
 		}
 	}
-	if (free_me && free_func) {
-		(*free_func)(*(void **)free_me);
+	if (hash_table->filter) {
+		int capacity = (int)(table_size * 0.69);
+		if (hash_table->flags & HASH_INCREMENTAL) {
+			// the filter only holds hashes, so it doesn't care where an entry lives. rebuilding it
+			// here would walk every entry and bring back the stall the incremental grow avoids, so
+			// it's left alone until it's actually full (_hash_place rebuilds it then), and sized
+			// for two grows ahead whenever it is rebuilt
+			if (!growing || hash_table->filter->capacity < hash_table->count) {
+				_hash_rebuild_filter(hash_table, 2 * (capacity > hash_table->count ? capacity : hash_table->count), hash_table->filter->fp_rate);
+			}
+		} else {
+			_hash_rebuild_filter(hash_table, capacity > hash_table->count ? capacity : hash_table->count, hash_table->filter->fp_rate);
+		}
+	}
+	if (hash_table->stats) {
+		if (growing) hash_table->stats->grows++;
+		else hash_table->stats->shrinks++;
+		_hash_stats_grow(hash_table->stats, start);
 	}
 }
 
-void __hash_grow(HashTable *hash_table) {
-	int old_table_size = hash_table->table_size;
+/* _hash_resize for tables with an epoch. relinking would send readers still walking an old
+ * bucket off into a new one, past entries they haven't looked at yet, so every entry is
+ * copied into the new array instead. the old array is left intact and retired as a whole */
+static void _hash_resize_copy(HashTable *hash_table, int table_size) {
+	LinkedList **buckets = _hash_new_buckets(hash_table, table_size);
+	if (!buckets) {
+		return;
+	}
+	int used_buckets = 0;
+	for (int i = 0; i < hash_table->table_size; i++) {
+		for (sl_node *node = hash_table->buckets[i]->head; node; node = node->next) {
+			_HashEntry *entry = (_HashEntry *)node;
+			size_t size = HASH_VALUE_OFFSET + entry->item.value_size;
+			_HashEntry *copy = alloc_malloc(hash_table->allocator, size);
+			if (!copy) {
+				printf("failed to allocate hash table entry");
+				COUNTERS_HOLD(hash_table->allocator);
+				_hash_reclaim_buckets(buckets, NULL);
+				return;
+			}
+			memcpy(copy, entry, size);
+			copy->item.data = (unsigned char *)copy + HASH_VALUE_OFFSET;
+			if (entry->item.key == entry->item.inline_key) {
+				copy->item.key = copy->item.inline_key;
+			}
+			copy->node.data = &copy->item;
+			LinkedList *bucket = buckets[entry->item.hash % table_size];
+			if (bucket->size == 0) used_buckets++;
+			_bucket_append_node(bucket, &copy->node);
+		}
+	}
+
+	// readers retry while resize_seq is odd, so they never pair one array with the other's size
 	LinkedList **old_buckets = hash_table->buckets;
+	int old_table_size = hash_table->table_size;
+	__EPOCH_STORE_INT(&hash_table->resize_seq, hash_table->resize_seq + 1);
+	__EPOCH_FENCE();
+	__EPOCH_STORE_PTR(&hash_table->buckets, buckets);
+	__EPOCH_STORE_INT(&hash_table->table_size, table_size);
+	__EPOCH_STORE_INT(&hash_table->resize_seq, hash_table->resize_seq + 1);
+	hash_table->used_buckets = used_buckets;
+	if (hash_table->stats) {
+		hash_table->stats->bytes_allocated -= (long long)old_table_size * (sizeof(LinkedList *) + sizeof(LinkedList));
+	}
+	// the values were copied, so the old entries go with their array and skip free_func.
+	// the array is freed through the table's allocator, which has to outlast the table if counted
+	COUNTERS_HOLD(hash_table->allocator);
+	_hash_retire(hash_table, old_buckets, _hash_reclaim_buckets, NULL);
+}
+
+/* number of buckets that holds capacity entries without growing. a table grows once half
+ * its buckets are used, and with a well spread hash that happens at about ln(2) = 0.69
+ * entries per bucket, so capacity is kept under that */
+static int _hash_size_for(int capacity) {
+	int table_size = 4;
+	while ((long long)table_size * 69 < (long long)capacity * 100) {
+		table_size *= 2;
+	}
+	return table_size;
+}
 
-	hash_table->table_size *= 2;
-	hash_table->buckets = malloc(hash_table->table_size * sizeof(LinkedList *));
+// moves every long owned key into a new key arena, then frees the old one, dropping the
+// space of keys that were removed. the table must not be migrating
+static void _hash_compact_keys(HashTable *hash_table) {
+	size_t key_bytes = 0;
 	for (int i = 0; i < hash_table->table_size; i++) {
-		hash_table->buckets[i] = link_create(SINGLY_LINKED_LIST);
+		for (sl_node *node = hash_table->buckets[i]->head; node; node = node->next) {
+			_HashItem *item = node->data;
+			if (item->key_len > HASH_INLINE_KEY_SIZE) {
+				key_bytes += item->key_len + 1;
+			}
+		}
 	}
-	hash_table->used_buckets = 0;
+	// every key goes into one allocation, so either all of them move or (when it can't be
+	// allocated) none do and the old arena stays
+	Arena *arena = NULL;
+	unsigned char *copy = NULL;
+	if (key_bytes) {
+		arena = arena_create(HASH_KEY_ARENA_BLOCK, hash_table->allocator);
+		copy = arena ? alloc_malloc(arena_allocator(arena), key_bytes) : NULL;
+		if (!copy) {
+			printf("failed to allocate hash table key arena");
+			arena_free(arena);
+			return;
+		}
+	}
+	Arena *old_arena = hash_table->key_arena;
+	hash_table->key_arena = arena;
+	for (int i = 0; i < hash_table->table_size; i++) {
+		for (sl_node *node = hash_table->buckets[i]->head; node; node = node->next) {
+			_HashItem *item = node->data;
+			if (item->key_len > HASH_INLINE_KEY_SIZE) {
+				memcpy(copy, item->key, item->key_len);
+				copy[item->key_len] = '\0';
+				// epoch readers may be comparing the old copy, so the pointer goes last
+				__EPOCH_STORE_PTR(&item->key, copy);
+				copy += item->key_len + 1;
+			}
+		}
+	}
+	if (hash_table->stats) {
+		hash_table->stats->bytes_allocated -= old_arena->bytes_reserved;
+		hash_table->stats->bytes_allocated += arena ? arena->bytes_reserved : 0;
+	}
+	COUNTERS_HOLD(hash_table->allocator);
+	_hash_retire(hash_table, old_arena, _hash_reclaim_arena, NULL);
+}
 
-	/* rehash all the data from the old array of buckets into the new one */
-	for (int i = 0; i < old_table_size; i++) {
-		LinkedList *old_bucket = old_buckets[i];
-		LINK_FOREACH(_HashItem, item, old_bucket,
-			unsigned int hash = (*hash_table->hash_func)(item.key);
-			unsigned int index = hash % hash_table->table_size;
-			if (LINK_SIZE(hash_table->buckets[index]) == 0)
-				hash_table->used_buckets++;
-			LINK_PUSH_BACK(_HashItem, hash_table->buckets[index], item);
-		);
-		while (LINK_SIZE(old_bucket) > 0) {
-			link_rem_front(old_bucket, NULL);
+// replaces the filter (if any) with one sized for capacity keys holding every key in the table
+static void _hash_rebuild_filter(HashTable *hash_table, int capacity, double fp_rate) {
+	BloomFilter *filter = bloom_create(capacity, fp_rate);
+	if (!filter) {
+		return;
+	}
+	for (int i = 0; i < hash_table->table_size; i++) {
+		for (sl_node *node = hash_table->buckets[i]->head; node; node = node->next) {
+			bloom_add_hash(filter, ((_HashItem *)node->data)->hash);
 		}
-		free(old_bucket);
 	}
-	free(old_buckets);
+	for (int i = hash_table->rehash_pos; hash_table->old_buckets && i < hash_table->old_table_size; i++) {
+		for (sl_node *node = hash_table->old_buckets[i]->head; node; node = node->next) {
+			bloom_add_hash(filter, ((_HashItem *)node->data)->hash);
+		}
+	}
+	// swapped in only once it is full, so readers never check a filter missing keys
+	BloomFilter *old_filter = hash_table->filter;
+	__EPOCH_STORE_PTR(&hash_table->filter, filter);
+	hash_table->filter_stale = 0;
+	if (old_filter) {
+		_hash_retire(hash_table, old_filter, _hash_reclaim_filter, NULL);
+	}
 }
 
-void* __hash_find(HashTable *hash_table, unsigned char *key) {
-	unsigned int hash = (*hash_table->hash_func)(key);
+// creates an entry in the key's bucket of the current array, copying val into it when given,
+// and returns its value storage. the caller has already grown the table and migrated the
+// key's old bucket if needed
+static void *_hash_place(HashTable *hash_table, unsigned char *key, int key_len, unsigned hash, void *val, int value_size) {
+	COUNTERS_OP(hash_table->counters, COUNTERS_ADD);
 	unsigned int index = hash % hash_table->table_size;
-	void *output = NULL;
-	LINK_FOREACH(_HashItem, item, hash_table->buckets[index],
-		if (strcmp(item.key,key) == 0) {
-			output = item.data;
-			break;
+	// node, item and value share one allocation
+	_HashEntry *entry = alloc_malloc(hash_table->allocator, HASH_VALUE_OFFSET + value_size);
+	if (!entry) {
+		printf("failed to allocate hash table entry");
+		return NULL;
+	}
+	_HashItem *new_item = &entry->item;
+	new_item->data = (unsigned char *)entry + HASH_VALUE_OFFSET;
+	new_item->value_size = value_size;
+	new_item->hash = hash;
+	new_item->key_len = key_len;
+	if (val) {
+		// before the entry is linked in, where epoch readers could see it
+		memcpy(new_item->data, val, value_size);
+	}
+	if (!_hash_store_key(hash_table, new_item, key, key_len)) {
+		alloc_free(hash_table->allocator, entry);
+		return NULL;
+	}
+	if (hash_table->filter) {
+		// a hash that spreads keys badly can fill the table well past what the filter was sized for
+		if (hash_table->count >= hash_table->filter->capacity) {
+			_hash_rebuild_filter(hash_table, 2 * (hash_table->count + 1), hash_table->filter->fp_rate);
 		}
-	);
-	return output;
+		// before the entry is linked in, so epoch readers never have it turned away
+		bloom_add_hash(hash_table->filter, hash);
+	}
+	entry->node.data = new_item;
+	sl_node *group_end = NULL;
+	if (hash_table->flags & HASH_MULTI) {
+		// keep every value of a key in one run, oldest first, by going after the last one
+		for (sl_node *node = hash_table->buckets[index]->head; node; node = node->next) {
+			_HashItem *item = node->data;
+			if (item->hash == hash && item->key_len == key_len && memcmp(item->key, new_item->key, key_len) == 0) {
+				group_end = node;
+			}
+			else if (group_end) {
+				break;
+			}
+		}
+	}
+	if (LINK_SIZE(hash_table->buckets[index]) == 0) hash_table->used_buckets++;
+	if (group_end) {
+		_bucket_insert_after(hash_table->buckets[index], group_end, &entry->node);
+	}
+	else {
+		_bucket_append_node(hash_table->buckets[index], &entry->node);
+	}
+	hash_table->count++;
+	if (hash_table->stats) {
+		hash_table->stats->bytes_allocated += HASH_VALUE_OFFSET + value_size;
+	}
+	return new_item->data;
 }
 
-void __attempt_freefunc_call(void(free_func)(void *), void *data) {
-	if (free_func && data) {
-		free_func(data);
+// frees every entry of one bucket along with the bucket itself
+static void _hash_free_bucket(LinkedList *bucket, void(free_func)(void *)) {
+	if (!free_func && alloc_is_region(bucket->allocator)) {
+		return;
 	}
+	sl_node *s = bucket->head;
+	while (s) {
+		_HashItem *item = s->data;
+		if (free_func && item->data) {
+			(*free_func)(*(void **)item->data);
+		}
+		sl_node *temp = s;
+		s = s->next;
+		alloc_free(bucket->allocator, temp);
+	}
+	alloc_free(bucket->allocator, bucket);
 }
 
-//---------------------------------------------------------
-// Private Functions:
-//---------------------------------------------------------
+// frees ptr with reclaim_func (or free when it is NULL), waiting for epoch readers first
+static void _hash_retire(HashTable *hash_table, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *)) {
+	if (hash_table->epoch) {
+		epoch_retire(hash_table->epoch, ptr, reclaim_func, free_func);
+	}
+	else if (reclaim_func) {
+		(*reclaim_func)(ptr, free_func);
+	}
+	else {
+		free(ptr);
+	}
+}
+
+// frees a removed entry once no epoch reader can reach it. entries from an allocator carry
+// it along in a _HashRetired, which comes from the same allocator
+static void _hash_retire_entry(HashTable *hash_table, sl_node *node, void(free_func)(void *)) {
+	if (!hash_table->allocator) {
+		_hash_retire(hash_table, node, _hash_reclaim_entry, free_func);
+		return;
+	}
+	if (hash_table->epoch) {
+		_HashRetired *retired = alloc_malloc(hash_table->allocator, sizeof(_HashRetired));
+		if (retired) {
+			retired->entry = (_HashEntry *)node;
+			retired->allocator = hash_table->allocator;
+			retired->free_func = free_func;
+			COUNTERS_HOLD(hash_table->allocator);
+			_hash_retire(hash_table, retired, _hash_reclaim_alloc_entry, NULL);
+			return;
+		}
+		// nowhere to keep the allocator, so wait out the readers and give the entry back now
+		printf("failed to allocate hash table retired entry");
+		epoch_synchronize(hash_table->epoch);
+	}
+	// nobody can still be reading it, so it goes straight back without a _HashRetired
+	_HashItem *item = node->data;
+	if (free_func && item->data) {
+		(*free_func)(*(void **)item->data);
+	}
+	alloc_free(hash_table->allocator, node);
+}
 
-// the default hashing algorithm. this can be replaced with a different function
+// frees a removed entry, and its value with free_func. the node is the start of the
+// entry, so this frees the item and value too
+static void _hash_reclaim_entry(void *entry, void(free_func)(void *)) {
+	_HashItem *item = ((sl_node *)entry)->data;
+	if (free_func && item->data) {
+		(*free_func)(*(void **)item->data);
+	}
+	free(entry);
+}
+
+// frees an entry handed over by _hash_retire_entry into the allocator it came from
+static void _hash_reclaim_alloc_entry(void *retired, void(free_func)(void *)) {
+	// the free_func passed at retire time travels in the _HashRetired
+	(void)free_func;
+	_HashRetired *r = retired;
+	Allocator *allocator = r->allocator;
+	_HashItem *item = &r->entry->item;
+	if (r->free_func && item->data) {
+		(*r->free_func)(*(void **)item->data);
+	}
+	alloc_free(allocator, r->entry);
+	alloc_free(allocator, r);
+	COUNTERS_RELEASE(allocator);
+}
+
+// frees a value replaced by HASH_REPLACE
+static void _hash_reclaim_value(void *value, void(free_func)(void *)) {
+	(*free_func)(value);
+}
+
+// frees a NULL terminated bucket array and every entry in it. the array comes from
+// the same allocator as its buckets, and there is always at least one. drops the
+// reference taken on that allocator's counters when the array was retired
+static void _hash_reclaim_buckets(void *buckets, void(free_func)(void *)) {
+	Allocator *allocator = ((LinkedList **)buckets)[0]->allocator;
+	for (LinkedList **bucket = buckets; *bucket; bucket++) {
+		_hash_free_bucket(*bucket, free_func);
+	}
+	alloc_free(allocator, buckets);
+	COUNTERS_RELEASE(allocator);
+}
+
+static void _hash_reclaim_filter(void *filter, void(free_func)(void *)) {
+	(void)free_func;
+	bloom_free(filter);
+}
+
+static void _hash_reclaim_arena(void *arena, void(free_func)(void *)) {
+	(void)free_func;
+	Allocator *parent = ((Arena *)arena)->parent;
+	arena_free(arena);
+	COUNTERS_RELEASE(parent);
+}
+
+// frees a table handed over by hash_free_async, on the reclaimer's thread
+static void _hash_reclaim_table(void *hash_table, void(free_func)(void *)) {
+	hash_free(hash_table, free_func);
+}
+
+// resolves up to HASH_BATCH_SIZE keys. every pass walks one level further down each
+// key's bucket (slot, list, first node, item, key bytes) and prefetches it, so by the
+// time the lookups run, the misses for the whole batch have been in flight together
+static void _hash_find_batch(HashTable *hash_table, unsigned char **keys, int *key_lens, int n, void **out) {
+	unsigned hashes[HASH_BATCH_SIZE];
+	int lens[HASH_BATCH_SIZE];
+	LinkedList *lists[HASH_BATCH_SIZE];
+	sl_node *nodes[HASH_BATCH_SIZE];
+
+	int table_size;
+	LinkedList **buckets = _hash_snapshot(hash_table, &table_size);
+	for (int i = 0; i < n; i++) {
+		lens[i] = key_lens ? key_lens[i] : (int)strlen((const char *)keys[i]);
+		hashes[i] = _hash_key(hash_table, keys[i], lens[i]);
+		PREFETCH(&buckets[hashes[i] % table_size]);
+	}
+	for (int i = 0; i < n; i++) {
+		lists[i] = buckets[hashes[i] % table_size];
+		PREFETCH(lists[i]);
+	}
+	for (int i = 0; i < n; i++) {
+		nodes[i] = __EPOCH_LOAD_PTR(&lists[i]->head);
+		if (nodes[i]) PREFETCH(nodes[i]);
+	}
+	for (int i = 0; i < n; i++) {
+		if (nodes[i]) PREFETCH(nodes[i]->data);
+	}
+	for (int i = 0; i < n; i++) {
+		if (nodes[i]) PREFETCH(__EPOCH_LOAD_PTR(&((_HashItem *)nodes[i]->data)->key));
+	}
+	for (int i = 0; i < n; i++) {
+		sl_node *node = _hash_lookup(hash_table, keys[i], lens[i], hashes[i]);
+		out[i] = node ? ((_HashItem *)node->data)->data : NULL;
+	}
+}
+
+// adds a copy of every item in bucket to new_table
+static void _hash_copy_bucket(HashTable *new_table, LinkedList *bucket, void *(copy_func)(void *), int size) {
+	LINK_FOREACH(_HashItem, item, bucket,
+		if (copy_func) {
+			void *copied_item = copy_func(*(void **)item.data);
+			__hash_add_bin(new_table, item.key, item.key_len, &copied_item, size);
+		}
+		else {
+			__hash_add_bin(new_table, item.key, item.key_len, item.data, item.value_size);
+		}
+	);
+}
+
+// the default hashing algorithm (FNV-1a). this can be replaced with a different function
 // when calling hash_create()
 static unsigned default_hash(unsigned char *string) {
-	unsigned i;
-	unsigned h = 0;
-	for (i = 0; string[i] != '\0'; i++) {
-		h += (i + 1) * string[i];
+	unsigned h = 2166136261u;
+	for (unsigned i = 0; string[i] != '\0'; i++) {
+		h ^= string[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+// default_hash for keys with an explicit length. gives the same result as
+// default_hash on any string without embedded '\0' bytes
+static unsigned default_hash_bin(unsigned char *key, int key_len) {
+	unsigned h = 2166136261u;
+	for (unsigned i = 0; i < (unsigned)key_len; i++) {
+		h ^= key[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+// seconds since an arbitrary point, for timing grows
+static double _hash_now(void) {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// records one lookup that looked at probes entries
+static void _hash_stats_probe(HashStats *stats, int probes, bool hit) {
+	stats->lookups++;
+	stats->lookup_probes += probes;
+	if (probes > stats->max_probes) stats->max_probes = probes;
+	if (!hit) {
+		stats->misses++;
+		stats->miss_probes += probes;
+		if (probes > stats->max_miss_probes) stats->max_miss_probes = probes;
+	}
+}
+
+// records the time spent growing since start
+static void _hash_stats_grow(HashStats *stats, double start) {
+	double seconds = _hash_now() - start;
+	stats->grow_seconds += seconds;
+	if (seconds > stats->max_grow_seconds) stats->max_grow_seconds = seconds;
+}
+
+// _hash_rehash_step, counted towards grow time when the table keeps stats
+static void _hash_timed_rehash_step(HashTable *hash_table, int steps) {
+	if (!hash_table->stats) {
+		_hash_rehash_step(hash_table, steps);
+		return;
 	}
-	return abs(h);
-}
\ No newline at end of file
+	double start = _hash_now();
+	_hash_rehash_step(hash_table, steps);
+	_hash_stats_grow(hash_table->stats, start);
+}
@@ -7,24 +7,104 @@
 #pragma once
 #include "dynarr.h"
 #include "linkList.h"
+#include "bloomFilter.h"
+#include "epoch.h"
+#include "allocator.h"
+#include "reclaimer.h"
+#include "counters.h"
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 
 //---------------------------------------------------------
 // Private Consts:
 //---------------------------------------------------------
 
+// number of old buckets migrated by every add or remove while an incremental grow is running
+#define HASH_REHASH_STEP 4
+
+// owned keys up to this many bytes are stored inside their entry instead of the key arena
+#define HASH_INLINE_KEY_SIZE 16
+
+// size of each block the key arena allocates for owned keys
+#define HASH_KEY_ARENA_BLOCK 65536
+
+// default low-water load (items per bucket). removing below it shrinks the table.
+// a shrink leaves the load between 0.35 and 0.69, so this has to stay well under 0.35
+#define HASH_SHRINK_LOAD 0.1f
+
+// number of chain lengths hash_stats counts separately. longer chains all go in the last one
+#define HASH_STATS_HISTOGRAM 16
+
+// number of keys the batched lookups hash and prefetch together before resolving them
+#define HASH_BATCH_SIZE 16
+
+// number of keys hash_bulk_load hashes ahead of placing them
+#define HASH_BULK_CHUNK 256
+
+// options that can be passed to hash_create_ex (combine with |)
+typedef enum {
+	HASH_DEFAULT		= 0,
+	HASH_INCREMENTAL	= 1 << 0,	// spread each grow across later adds/removes instead of rehashing at once
+	HASH_OWN_KEYS		= 1 << 1,	// copy keys into the table so callers don't have to keep them alive
+	HASH_STATS			= 1 << 2,	// count probes, key compares, grows and memory (see hash_stats)
+	HASH_MULTI			= 1 << 3,	// keep every value added under the same key next to each other
+} HashTableFlags;
+
 //---------------------------------------------------------
 // Private Structures:
 //---------------------------------------------------------
 
+typedef struct {
+	long long lookups;				// finds, exists and removes
+	long long lookup_probes;		// entries looked at by all lookups
+	int max_probes;					// most entries any one lookup looked at
+	long long misses;				// lookups that didn't find their key
+	long long miss_probes;			// entries looked at by lookups that missed
+	int max_miss_probes;			// most entries any one miss looked at
+	long long key_compares;			// memcmp calls made to confirm a key
+	long long filter_rejects;		// misses answered by the filter without touching a bucket
+	int grows;						// number of times the bucket array got bigger
+	int shrinks;					// number of times the bucket array got smaller
+	double grow_seconds;			// total time spent resizing and migrating buckets
+	double max_grow_seconds;		// longest single resize (or incremental migration step)
+	long long bytes_allocated;		// bytes held by the table itself, buckets, entries and keys
+	int chain_histogram[HASH_STATS_HISTOGRAM];	// number of buckets holding 0, 1, 2 ... entries
+} HashStats;
+
 typedef struct {
 	int count;						        // number of elements stored
 	int table_size;					        // number of buckets
 	int used_buckets;				        // number of buckets holding data
 	unsigned(*hash_func)(unsigned char *);	// function used to hash data
 	LinkedList **buckets;			        // array of buckets
+	int flags;						        // HashTableFlags the table was created with
+	LinkedList **old_buckets;		        // buckets still being migrated by an incremental grow (or NULL)
+	int old_table_size;				        // number of buckets in old_buckets
+	int rehash_pos;					        // old buckets below this index have been migrated
+	unsigned(*hash_bin_func)(unsigned char *, int);	// length aware hash used for every key (or NULL)
+	Arena *key_arena;				        // append-only storage for owned keys (or NULL)
+	HashStats *stats;				        // counters kept when created with HASH_STATS (or NULL)
+	int value_size;					        // size of every value given to hash_create_sized (or 0)
+	float shrink_load;				        // shrink once count / table_size drops below this (0 never)
+	BloomFilter *filter;			        // filter checked before any bucket (or NULL)
+	int filter_stale;				        // removed keys the filter still answers "maybe" for
+	Epoch *epoch;					        // readers to wait for before freeing what they might see (or NULL)
+	int resize_seq;					        // odd while an epoch table swaps its bucket array
+	Allocator *allocator;			        // where the table, buckets, entries and keys come from (or NULL for malloc)
+	Counters *counters;				        // allocations and operations, with DS_ENABLE_COUNTERS (or NULL)
 } HashTable;
 
+// walks every value stored under one key (see hash_find_all)
+typedef struct {
+	sl_node *node;					        // next node to check
+	unsigned char *key;				        // the key being searched for
+	int key_len;					        // number of bytes in key
+	unsigned hash;					        // hash of key
+	bool grouped;					        // the table keeps equal keys together (HASH_MULTI)
+	bool found;						        // a match has been returned already
+} HashIter;
+
 //---------------------------------------------------------
 // Public Variables:
 //---------------------------------------------------------
@@ -43,10 +123,80 @@ typedef struct {
 */
 HashTable *hash_create(unsigned(hash_func)(unsigned char *));
 
+/**
+* @brief		Allocates and initializes a new HashTable ptr with extra options
+* @details		with HASH_INCREMENTAL, growing allocates the bigger bucket array but leaves the
+*				entries where they are. every following add or remove then migrates
+*				HASH_REHASH_STEP old buckets, and lookups check both arrays until the
+*				migration is done. no single insert has to rehash the whole table. a bloom
+*				filter (hash_set_filter) isn't rebuilt by these grows either.
+*
+* @param[in]	hash_func - function that takes a string and returns a "unique" unsigned int.
+* @param[in]	flags	  - HashTableFlags combined with |, or HASH_DEFAULT
+* @return		a pointer to a newly allocated and empty hash table
+*/
+HashTable *hash_create_ex(unsigned(hash_func)(unsigned char *), int flags);
+
+/**
+* @brief		Allocates and initializes a new HashTable ptr with room for a number of items
+* @details		the bucket array starts big enough that capacity items can be added
+*				without the table ever growing.
+*
+* @param[in]	hash_func - function that takes a string and returns a "unique" unsigned int.
+* @param[in]	capacity  - the number of items you expect to add
+* @param[in]	flags	  - HashTableFlags combined with |, or HASH_DEFAULT
+* @return		a pointer to a newly allocated and empty hash table
+*/
+HashTable *hash_create_with_capacity(unsigned(hash_func)(unsigned char *), int capacity, int flags);
+
+/**
+* @brief		Allocates and initializes a new HashTable ptr that gets its memory from an allocator
+* @details		the table, its buckets, entries and owned keys all come from allocator, which has
+*				to outlive the table. put a table built for one request on an arena_allocator and
+*				free the arena afterwards. with an epoch, only writers use the allocator.
+*
+* @param[in]	hash_func - function that takes a string and returns a "unique" unsigned int.
+* @param[in]	capacity  - the number of items you expect to add
+* @param[in]	flags	  - HashTableFlags combined with |, or HASH_DEFAULT
+* @param[in]	allocator - the allocator to use, i.e arena_allocator(arena). NULL uses malloc
+* @return		a pointer to a newly allocated and empty hash table
+*/
+HashTable *hash_create_alloc(unsigned(hash_func)(unsigned char *), int capacity, int flags, Allocator *allocator);
+
+/**
+* @brief		Allocates and initializes a new HashTable ptr that hashes keys by length
+* @details		use this when keys may contain '\0' bytes and you want your own hashing function.
+*				tables made with a NULL hash_func already hash every key by its length.
+*
+* @param[in]	hash_func - function that takes a key and its length and returns a "unique" unsigned int.
+* @param[in]	flags	  - HashTableFlags combined with |, or HASH_DEFAULT
+* @return		a pointer to a newly allocated and empty hash table
+*/
+HashTable *hash_create_bin(unsigned(hash_func)(unsigned char *, int), int flags);
+
+/**
+* @brief		Allocates and initializes a new HashTable ptr that holds values of one size
+* @details		every entry is a single allocation holding its list node, key info and value,
+*				so adding never allocates more than once. values of any size are still accepted,
+*				value_size is what hash_copy uses when it isn't given a size.
+*
+* @param[in]	hash_func  - function that takes a string and returns a "unique" unsigned int.
+* @param[in]	value_size - the size of every value. i.e sizeof(int)
+* @param[in]	flags	   - HashTableFlags combined with |, or HASH_DEFAULT
+* @return		a pointer to a newly allocated and empty hash table
+*/
+HashTable *hash_create_sized(unsigned(hash_func)(unsigned char *), int value_size, int flags);
+
 /**
 * @brief		Makes a copy of an existing hash table
+* @details		without copy_func every value is copied byte for byte at the size it was added with.
+*				with copy_func, values are pointers: copy_func gets each one and size bytes
+*				of what it returns are stored (0 uses the table's value_size, or
+*				sizeof(void *) if it has none).
 *
 * @param[in]	hash_table - the HashTable to copy
+* @param[in]	copy_func  - function that deep copies a stored pointer (or NULL)
+* @param[in]	size_t	   - the size of what copy_func returns. i.e sizeof(char *)
 * @return		a new HashTable with copies of the input data.
 */
 HashTable *hash_copy(HashTable *hash_table, void *(copy_func)(void *), int size_t);
@@ -54,6 +204,8 @@ HashTable *hash_copy(HashTable *hash_table, void *(copy_func)(void *), int size_
 /**
 * @brief		frees an entire hash table and all of its contents
 * @details		leave free_func NULL if the contents are not pointers or you wish to not free them.
+*				on a region allocator (i.e an arena) with no free_func, no entry is visited,
+*				the region gets the memory back when it is dropped.
 *
 * @param[in]	hash_table - the hash table to free
 * @param[in]	free_func  - this function will be called on every element that you've inserted
@@ -61,6 +213,100 @@ HashTable *hash_copy(HashTable *hash_table, void *(copy_func)(void *), int size_
 */
 void hash_free(HashTable *hash_table, void(free_func)(void *));
 
+/**
+* @brief		frees an entire hash table and its contents on a reclaimer's thread
+* @details		use this to drop a big table (i.e a cache being swapped out) without waiting
+*				for every entry to be visited. the table is handed over in O(1), and hash_free
+*				runs later on the reclaimer's thread, where free_func and the table's allocator
+*				(unless it's a region) are called. with an epoch, readers must be done with it first.
+*
+* @param[in]	hash_table - the hash table to free. don't use it after this
+* @param[in]	free_func  - called on every element, on the reclaimer's thread
+* @param[in]	reclaimer  - the reclaimer that frees the table
+*/
+void hash_free_async(HashTable *hash_table, void(free_func)(void *), Reclaimer *reclaimer);
+
+/**
+* @brief		makes room for capacity items in total
+* @details		grows the bucket array once, straight to the size capacity items need,
+*				instead of doubling over and over while they are added. never shrinks the table.
+*
+* @param[in]	hash_table - the table to grow
+* @param[in]	capacity   - the total number of items the table should hold without growing
+*/
+void hash_reserve(HashTable *hash_table, int capacity);
+
+/**
+* @brief		sets how empty a table can get before removing items shrinks it
+* @details		a table shrinks to the size its remaining items need once
+*				count / table_size drops below low_water. since that size is well above
+*				low_water, adding and removing around the limit doesn't resize over and over.
+*				tables start with HASH_SHRINK_LOAD.
+*
+* @param[in]	hash_table - the table to configure
+* @param[in]	low_water  - items per bucket to shrink below, under 0.35. 0 never shrinks
+*/
+void hash_set_shrink_load(HashTable *hash_table, float low_water);
+
+/**
+* @brief		puts a bloom filter in front of a hash table
+* @details		every lookup (finds, exists and removes) checks the filter first, so most keys
+*				that aren't in the table are turned away after reading one cache line, without
+*				walking a bucket. the filter is rebuilt from the table's cached hashes whenever
+*				the table resizes, and once removed keys outnumber the ones left. on a
+*				HASH_INCREMENTAL table grows leave the filter alone, since rebuilding it walks
+*				every entry. it's sized for twice the table instead, and rebuilt (at twice the
+*				count) by the add that fills it, so a filter costs one full walk every other grow.
+*
+* @param[in]	hash_table - the table to filter
+* @param[in]	fp_rate	   - how often a missing key still has to check its bucket. i.e 0.01.
+*				0 removes the filter
+*/
+void hash_set_filter(HashTable *hash_table, double fp_rate);
+
+/**
+* @brief		gives back memory a table no longer needs
+* @details		finishes any incremental grow, shrinks the bucket array to the size the current
+*				items need and, with HASH_OWN_KEYS, copies the long keys still in use into a
+*				fresh key arena so the space of removed keys is freed. a filter is rebuilt
+*				without the removed keys.
+*				pointers from HASH_FIND_PTR stay valid, unless the table has an epoch.
+*
+* @param[in]	hash_table - the table to compact
+*/
+void hash_compact(HashTable *hash_table);
+
+/**
+* @brief		adds many items at once to a table made with hash_create_sized
+* @details		the table is sized once for everything, then keys are hashed a chunk at a time
+*				and placed directly, skipping the load check every single add makes.
+*				keys are added even if they are already in the table, same as HASH_ADD.
+*
+* @param[in]	hash_table - the table to add to
+* @param[in]	keys	   - array of n key strings
+* @param[in]	values	   - array of n values, each the table's value_size bytes
+* @param[in]	n		   - the number of items
+*/
+void hash_bulk_load(HashTable *hash_table, unsigned char **keys, void *values, int n);
+
+/**
+* @brief		lets other threads read a hash table without locking while it is changed
+* @details		readers wrap every lookup (and any use of the values it returns) in
+*				epoch_enter / epoch_exit. removed entries and values, replaced bucket arrays,
+*				filters and key blocks are then handed to the epoch instead of being freed,
+*				so a reader never touches freed memory. resizing copies entries rather than
+*				relinking them, and HASH_INCREMENTAL is ignored.
+*				writers still have to be serialized with a lock of your own, and must not
+*				hold a read section while writing. values are written in place by
+*				HASH_REPLACE, so only replace values a reader can read in one go (i.e pointers).
+*				stats counters are updated by readers without synchronization, so they are approximate.
+*				call this before sharing the table. the epoch can be shared with other tables.
+*
+* @param[in]	hash_table - the table readers will share
+* @param[in]	epoch	   - the epoch readers enter, or NULL to go back to freeing immediately
+*/
+void hash_set_epoch(HashTable *hash_table, Epoch *epoch);
+
 /**
 * @brief		boolian function used to determine weather an element with a given key is in the table
 * @details		
@@ -71,18 +317,179 @@ void hash_free(HashTable *hash_table, void(free_func)(void *));
 */
 bool hash_exists(HashTable *hash_table, unsigned char *key);
 
+/**
+* @brief		reports how well a hash table is performing
+* @details		chain_histogram is always filled in by walking the buckets. the counters
+*				are only kept by tables created with HASH_STATS, and are 0 otherwise.
+*				a lopsided histogram or high probe counts point at a bad hash_func,
+*				a high grow time points at resizing.
+*
+* @param[in]	hash_table - the table to report on
+* @param[out]	out		   - receives the statistics
+*/
+void hash_stats(HashTable *hash_table, HashStats *out);
+
+/**
+* @brief		zeroes the counters kept by a HASH_STATS table
+* @details		bytes_allocated is left alone since the memory is still held
+*
+* @param[in]	hash_table - the table to reset
+*/
+void hash_stats_reset(HashTable *hash_table);
+
+/**
+* @brief		writes hash_stats as a JSON object, including average probe counts
+*
+* @param[in]	hash_table - the table to report on
+* @param[in]	out		   - the stream to write to. i.e stdout
+*/
+void hash_stats_dump_json(HashTable *hash_table, FILE *out);
+
+/**
+* @brief		looks up many keys at once
+* @details		keys are handled HASH_BATCH_SIZE at a time: all of them are hashed first, then
+*				their buckets, nodes and items are prefetched one level at a time so the
+*				cache misses of different keys overlap instead of happening one after another.
+*
+* @param[in]	hash_table - the table to search
+* @param[in]	keys	   - array of n key strings
+* @param[in]	n		   - the number of keys
+* @param[out]	out		   - array of n pointers that receive each item (or NULL if it wasn't found)
+*/
+void hash_find_many(HashTable *hash_table, unsigned char **keys, int n, void **out);
+
+/**
+* @brief		checks weather each of many keys is in the table
+* @details		batched and prefetched the same way as hash_find_many
+*
+* @param[in]	hash_table - the table to search
+* @param[in]	keys	   - array of n key strings
+* @param[in]	n		   - the number of keys
+* @param[out]	out		   - array of n bools that receive weather each key was found
+*/
+void hash_exists_many(HashTable *hash_table, unsigned char **keys, int n, bool *out);
+
+/**
+* @brief		looks up many binary keys at once
+* @details		same as hash_find_many, but every key comes with its length
+*
+* @param[in]	hash_table - the table to search
+* @param[in]	keys	   - array of n keys
+* @param[in]	key_lens   - array of n key lengths
+* @param[in]	n		   - the number of keys
+* @param[out]	out		   - array of n pointers that receive each item (or NULL if it wasn't found)
+*/
+void hash_find_many_bin(HashTable *hash_table, unsigned char **keys, int *key_lens, int n, void **out);
+
 /**
 * @brief		removes an element that matches the given key from a hash table
-* @details		if more than one element matches the key, only one element will be removed
+* @details		if more than one element matches the key, only one element will be removed.
+*				the table shrinks when it gets too empty (see hash_set_shrink_load)
 *
 * @param[in]	hash_table - the table to remove from
 * @param[in]	key		   - the key value to search for
 */
 void hash_rem(HashTable *hash_table, unsigned char *key, void(free_func)(void *));
 
+/**
+* @brief		starts walking every item stored under a key
+* @details		HASH_ADD keeps every item added under the same key, so a table can be used as a
+*				multimap. pass the result to hash_iter_next until it returns NULL.
+*				items come back in the order they were added when the table was created with
+*				HASH_MULTI, which also stores them next to each other so the walk stops as soon
+*				as they run out. don't add or remove items while walking.
+*
+* @param[in]	hash_table - the table to search
+* @param[in]	key		   - the key string to search for (must stay alive while walking)
+* @return		an iterator over the items stored under key
+*/
+HashIter hash_find_all(HashTable *hash_table, unsigned char *key);
+
+/**
+* @brief		starts walking every item stored under a binary key
+*
+* @param[in]	hash_table - the table to search
+* @param[in]	key		   - the key bytes to search for (must stay alive while walking)
+* @param[in]	key_len	   - the number of bytes in key
+* @return		an iterator over the items stored under key
+*/
+HashIter hash_find_all_bin(HashTable *hash_table, unsigned char *key, int key_len);
+
+/**
+* @brief		moves an iterator from hash_find_all to the next item
+*
+* @param[in]	iter - the iterator to advance
+* @return		a pointer to the next item (like HASH_FIND_PTR), or NULL once there are no more
+*/
+void *hash_iter_next(HashIter *iter);
+
+/**
+* @brief		counts the items stored under a key
+*
+* @param[in]	hash_table - the table to search
+* @param[in]	key		   - the key string to search for
+* @return		the number of items stored under key
+*/
+int hash_count_key(HashTable *hash_table, unsigned char *key);
+
+/**
+* @brief		counts the items stored under a binary key
+*
+* @param[in]	hash_table - the table to search
+* @param[in]	key		   - the key bytes to search for
+* @param[in]	key_len	   - the number of bytes in key
+* @return		the number of items stored under key
+*/
+int hash_count_key_bin(HashTable *hash_table, unsigned char *key, int key_len);
+
+/**
+* @brief		removes every item stored under a key
+*
+* @param[in]	hash_table - the table to remove from
+* @param[in]	key		   - the key string to search for
+* @param[in]	free_func  - function to call on every removed item (or NULL)
+* @return		the number of items removed
+*/
+int hash_rem_all(HashTable *hash_table, unsigned char *key, void(free_func)(void *));
+
+/**
+* @brief		removes every item stored under a binary key
+*
+* @param[in]	hash_table - the table to remove from
+* @param[in]	key		   - the key bytes to search for
+* @param[in]	key_len	   - the number of bytes in key
+* @param[in]	free_func  - function to call on every removed item (or NULL)
+* @return		the number of items removed
+*/
+int hash_rem_all_bin(HashTable *hash_table, unsigned char *key, int key_len, void(free_func)(void *));
+
+/**
+* @brief		boolian function used to determine weather an element with a binary key is in the table
+* @details		keys are compared by length and bytes, so they may contain '\0'.
+*				the table needs a length aware hash (see hash_create_bin)
+*
+* @param[in]	hash_table - the table to search
+* @param[in]	key		   - the key bytes to search for
+* @param[in]	key_len	   - the number of bytes in key
+* @return		1 if the key is found, 0 if it was not.
+*/
+bool hash_exists_bin(HashTable *hash_table, unsigned char *key, int key_len);
+
+/**
+* @brief		removes an element that matches the given binary key from a hash table
+* @details		if more than one element matches the key, only one element will be removed.
+*				owned keys longer than HASH_INLINE_KEY_SIZE stay in the key arena until hash_free.
+*
+* @param[in]	hash_table - the table to remove from
+* @param[in]	key		   - the key bytes to search for
+* @param[in]	key_len	   - the number of bytes in key
+*/
+void hash_rem_bin(HashTable *hash_table, unsigned char *key, int key_len, void(free_func)(void *));
+
 /**
 * @brief		adds an item to the hash table
 * @details		the item can be any type, but make sure you keep track of what type it is...
+*				the value is stored inside the entry, so this makes one allocation.
 *
 * @param[in]	hash_table - the table to add to
 * @param[in]	val		   - the actual data you would like to add
@@ -90,37 +497,40 @@ void hash_rem(HashTable *hash_table, unsigned char *key, void(free_func)(void *)
 */
 #define HASH_ADD(type_t, hash_table, val, key_string)										\
 	do {																					\
-		float loadFactor = (float)hash_table->used_buckets / hash_table->table_size;		\
-		if (loadFactor >= 0.5f ) __hash_grow(hash_table);									\
-		unsigned int hash = (*hash_table->hash_func)(key_string);							\
-		unsigned int index = hash % hash_table->table_size;									\
-		if(LINK_SIZE(hash_table->buckets[index]) == 0) hash_table->used_buckets++;			\
-		_HashItem new_item = {malloc(sizeof(type_t)), key_string};							\
-		*(type_t *)(new_item.data) = val;													\
-		LINK_PUSH_BACK(_HashItem, hash_table->buckets[index], new_item);					\
-		hash_table->count++;																\
+		type_t _hash_val = val;																\
+		__hash_add(hash_table, key_string, &_hash_val, sizeof(type_t));					\
 	} while (0)
 
 
 /**
-* @brief		adds an item to the hash table
+* @brief		adds an item of a given size to the hash table
 * @details		the item can be any type, but make sure you keep track of what type it is...
+*				value_size bytes starting at &val are copied into the entry.
 *
+* @param[in]	value_size - the number of bytes to store. i.e sizeof(val)
 * @param[in]	hash_table - the table to add to
-* @param[in]	val		   - the actual data you would like to add
+* @param[in]	val		   - the actual data you would like to add (must be addressable)
 * @param[in]	key_string - a unique lookup string for accessing your data later
 */
-#define HASH_ADD_SIZE(size_t, hash_table, val, key_string)									\
+#define HASH_ADD_SIZE(value_size, hash_table, val, key_string)								\
 	do {																					\
-		float loadFactor = (float)hash_table->used_buckets / hash_table->table_size;		\
-		if (loadFactor >= 0.5f ) __hash_grow(hash_table);									\
-		unsigned int hash = (*hash_table->hash_func)(key_string);							\
-		unsigned int index = hash % hash_table->table_size;									\
-		if(LINK_SIZE(hash_table->buckets[index]) == 0) hash_table->used_buckets++;			\
-		_HashItem new_item = {malloc(sizeof(size_t)), key_string};							\
-		memcpy_s(new_item.data, size_t, &val, size_t)										\
-		LINK_PUSH_BACK(_HashItem, hash_table->buckets[index], new_item);					\
-		hash_table->count++;																\
+		__hash_add(hash_table, key_string, &(val), value_size);								\
+	} while (0)
+
+/**
+* @brief		adds an item to the hash table under a binary key
+* @details		with HASH_OWN_KEYS the key bytes are copied, otherwise key must stay alive
+*				as long as the item is in the table.
+*
+* @param[in]	hash_table - the table to add to
+* @param[in]	val		   - the actual data you would like to add
+* @param[in]	key		   - the key bytes (may contain '\0')
+* @param[in]	key_len	   - the number of bytes in key
+*/
+#define HASH_ADD_BIN(type_t, hash_table, val, key, key_len)								\
+	do {																					\
+		type_t _hash_val = val;																\
+		__hash_add_bin(hash_table, key, key_len, &_hash_val, sizeof(type_t));				\
 	} while (0)
 
 /**
@@ -133,9 +543,62 @@ void hash_rem(HashTable *hash_table, unsigned char *key, void(free_func)(void *)
 */
 #define HASH_FIND(type_t, hash_table, key_string) (*(type_t *)__hash_find(hash_table, key_string))
 
+/**
+* @brief		retrieves an item stored under a binary key
+* @details		if the item isn't found, behavior is undefined. use hash_exists_bin() first.
+*
+* @param[in]	hash_table - the table to retrieve from
+* @param[in]	key		   - the key bytes you inserted your item with.
+* @param[in]	key_len	   - the number of bytes in key
+*/
+#define HASH_FIND_BIN(type_t, hash_table, key, key_len) (*(type_t *)__hash_find_bin(hash_table, key, key_len))
+
+/**
+* @brief		returns a pointer to an item in a hash table, or NULL if it isn't there
+* @details		the pointer is to the value stored inside the table, so it can be used to
+*				update the item in place. it stays valid until the item is removed or the table freed.
+*				with hash_set_epoch, resizing moves items, so only use it inside the read section.
+*
+* @param[in]	type_t	   - the type of data being accessed. i.e (int), (double *), etc.
+* @param[in]	hash_table - the table to retrieve from
+* @param[in]	key_string - the lookup string you inserted your item with.
+*/
+#define HASH_FIND_PTR(type_t, hash_table, key_string) ((type_t *)__hash_find(hash_table, key_string))
+
+/**
+* @brief		returns a pointer to an item stored under a binary key, or NULL if it isn't there
+*
+* @param[in]	type_t	   - the type of data being accessed. i.e (int), (double *), etc.
+* @param[in]	hash_table - the table to retrieve from
+* @param[in]	key		   - the key bytes you inserted your item with.
+* @param[in]	key_len	   - the number of bytes in key
+*/
+#define HASH_FIND_PTR_BIN(type_t, hash_table, key, key_len) ((type_t *)__hash_find_bin(hash_table, key, key_len))
+
+/**
+* @brief		run code with every item stored under a key
+* @details		see hash_find_all. don't add or remove items inside run.
+*
+* @param[in]	type_t	   - the type of data being accessed. i.e (int), (double *), etc.
+* @param[in]	item	   - your chosen variable name for the current item
+* @param[in]	hash_table - the table to search
+* @param[in]	key_string - the lookup string the items were inserted with.
+* @param[in]	run		   - the code you would like to run. this can be multiple lines long
+*/
+#define HASH_FOREACH_KEY(type_t, item, hash_table, key_string, run)							\
+do {																						\
+	HashIter _hash_iter = hash_find_all(hash_table, key_string);							\
+	void *_hash_item;																		\
+	while ((_hash_item = hash_iter_next(&_hash_iter))) {									\
+		type_t item = *(type_t *)_hash_item;												\
+		run;																				\
+	}																						\
+} while (0)
+
 /**
 * @brief		replaces an item at a key
-* @details		if the item isn't found, the item is not replaced
+* @details		if the item isn't found, the item is not replaced.
+*				like hash_rem, free_func is given the item itself (for items that are pointers)
 *
 * @param[in]	hash_table    - the table to replace in
 * @param[in]	type_t		  - the data type you're replacing and replacing with
@@ -145,20 +608,10 @@ void hash_rem(HashTable *hash_table, unsigned char *key, void(free_func)(void *)
 */
 #define HASH_REPLACE(hash_table, type_t, val, key_string, free_func)    \
 do {																    \
-	unsigned int hash = (*hash_table->hash_func)(key_string);		    \
-	unsigned int index = hash % hash_table->table_size;				    \
-	LinkedList *list = hash_table->buckets[index];					    \
-	sl_node *node = list->head;										    \
-	if (list->size) {												    \
-		do {														    \
-			_HashItem item = (*(_HashItem *)node->data);			    \
-			if (strcmp(item.key, key_string) == 0) {			        \
-				__attempt_freefunc_call(free_func, item.data);		    \
-				*(type_t *)item.data = val;							    \
-				break;												    \
-			}														    \
-			node = node->next;										    \
-		} while (node);							                        \
+	void *data_ptr = __hash_find(hash_table, key_string);			    \
+	if (data_ptr) {													    \
+		__attempt_freefunc_call(hash_table, free_func, data_ptr);	    \
+		*(type_t *)data_ptr = val;									    \
 	}																    \
 } while (0)
 
@@ -166,10 +619,17 @@ do {																    \
 // ignore these helper functions / structs
 
 void __hash_grow(HashTable *hash_table);
+void *__hash_add(HashTable *hash_table, unsigned char *key, void *val, int value_size);
+void *__hash_add_bin(HashTable *hash_table, unsigned char *key, int key_len, void *val, int value_size);
 void* __hash_find(HashTable *hash_table, unsigned char *key);
-void __attempt_freefunc_call(void(free_func)(void *), void *data);
+void* __hash_find_bin(HashTable *hash_table, unsigned char *key, int key_len);
+void __attempt_freefunc_call(HashTable *hash_table, void(free_func)(void *), void *data);
 
 typedef struct {
-	void *data;
+	void *data;			// the value, stored in the same allocation right after the item
+	int value_size;		// number of bytes at data
 	unsigned char *key;
+	unsigned hash;		// full hash of key, cached so grows and misses never rehash
+	int key_len;		// number of bytes in key
+	unsigned char inline_key[HASH_INLINE_KEY_SIZE + 1];	// storage for short owned keys
 }_HashItem;
\ No newline at end of file
@@ -0,0 +1,306 @@
+//---------------------------------------------------------
+// file:    heap.h
+// author:  Jordan Hoffmann
+// brief:   Library for priority queues (d-ary heaps) generated per type
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// capacity of a heap made with name_create()
+#define HEAP_MIN_CAPACITY 8
+
+// returned instead of a handle when an item wasn't added
+#define HEAP_NO_HANDLE (-1)
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		declares a heap (priority queue) type and its functions
+* @details		items are stored inline in one array, so a push never allocates unless the heap grows.
+*				every item gets a handle when it's pushed, which stays the same while the item moves
+*				around the heap, so it can be found, reprioritized or removed later. a handle is
+*				given to a later item once its own item is popped, removed or dropped.
+*				put this in a header, and HEAP_DEFINE with the same name and type in one .c file.
+*
+*				generates:
+*				name    *name_create(void);
+*				name    *name_create_bounded(int k);			(only ever holds k items, see name_offer)
+*				name    *name_heapify(const item_t *items, int count);	(O(count), handle i is items[i])
+*				void     name_free(name *heap);
+*				int      name_push(name *heap, item_t item);		(the item's handle, or HEAP_NO_HANDLE)
+*				bool     name_offer(name *heap, item_t item, item_t *dropped);	(true if an item was dropped)
+*				item_t  *name_top(name *heap);					(NULL if the heap is empty)
+*				bool     name_pop(name *heap, item_t *out);		(false if the heap is empty)
+*				item_t  *name_get(name *heap, int handle);		(NULL if the handle isn't in use)
+*				bool     name_update(name *heap, int handle, item_t item);	(decrease or increase key)
+*				bool     name_rem(name *heap, int handle, item_t *out);
+*
+* @param[in]	name   - the name of the heap type, also used as the prefix of its functions
+* @param[in]	item_t - the type of the items, i.e a struct holding a priority and some data
+*/
+#define HEAP_DECLARE(name, item_t)																\
+	/* so const applies to the item even when item_t is a pointer type */					\
+	typedef item_t name##_item;																\
+	typedef struct {																		\
+		item_t item;																		\
+		int handle;																			\
+	} name##_entry;																			\
+	typedef struct {																		\
+		int count;				/* number of items stored							*/		\
+		int capacity;			/* number of entries allocated						*/		\
+		int bound;				/* most items kept (0 for no limit)					*/		\
+		int free_handle;		/* most recently released handle (or -1)			*/		\
+		name##_entry *entries;	/* the heap, top first								*/		\
+		int *slot_of;			/* entry index of each handle (or the next free one)	*/	\
+	} name;																					\
+	name *name##_create(void);																\
+	name *name##_create_bounded(int k);														\
+	name *name##_heapify(const name##_item *items, int count);								\
+	void name##_free(name *heap);															\
+	int name##_push(name *heap, item_t item);												\
+	bool name##_offer(name *heap, item_t item, item_t *dropped);							\
+	item_t *name##_top(name *heap);															\
+	bool name##_pop(name *heap, item_t *out);												\
+	item_t *name##_get(name *heap, int handle);												\
+	bool name##_update(name *heap, int handle, item_t item);								\
+	bool name##_rem(name *heap, int handle, item_t *out)
+
+/**
+* @brief		defines the functions declared by HEAP_DECLARE
+* @details		use exactly once per heap type, in a .c file that has seen HEAP_DECLARE.
+*				before(a, b) is true when item a should come out before item b, so a min heap of
+*				ints is #define int_less(a, b) ((a) < (b)). it can be a macro or a function.
+*				arity is how many children each entry has. 2 is a binary heap. 4 is usually faster
+*				once the heap outgrows the cache, since the children a pop compares share a cache
+*				line and the heap is half as deep, at the cost of more compares per level.
+*
+*				a bounded heap (name_create_bounded) keeps the k items that would come out last:
+*				a min heap bounded to k holds the k largest items, and its top is the smallest of those.
+*
+* @param[in]	name   - the same name given to HEAP_DECLARE
+* @param[in]	item_t - the same item type given to HEAP_DECLARE
+* @param[in]	before - the ordering, called as before(a, b) with two item_t
+* @param[in]	arity  - children per entry, 2 or more
+*/
+#define HEAP_DEFINE(name, item_t, before, arity)												\
+	static name *name##__create(int capacity, int bound) {									\
+		name *heap = malloc(sizeof(name));													\
+		if (!heap) {																		\
+			printf("failed to allocate heap");												\
+			return NULL;																	\
+		}																					\
+		heap->count = 0;																	\
+		heap->capacity = capacity < 1 ? 1 : capacity;										\
+		heap->bound = bound;																\
+		heap->free_handle = -1;																\
+		heap->entries = malloc(heap->capacity * sizeof(name##_entry));						\
+		heap->slot_of = malloc(heap->capacity * sizeof(int));								\
+		if (!heap->entries || !heap->slot_of) {												\
+			printf("failed to allocate heap entries");										\
+			free(heap->entries);															\
+			free(heap->slot_of);															\
+			free(heap);																		\
+			return NULL;																	\
+		}																					\
+		for (int _ii = 0; _ii < heap->capacity; _ii++) heap->slot_of[_ii] = -1;			\
+		return heap;																		\
+	}																						\
+	name *name##_create(void) {																\
+		return name##__create(HEAP_MIN_CAPACITY, 0);										\
+	}																						\
+	name *name##_create_bounded(int k) {													\
+		return name##__create(k, k < 1 ? 1 : k);											\
+	}																						\
+	void name##_free(name *heap) {															\
+		if (heap) {																			\
+			free(heap->entries);															\
+			free(heap->slot_of);															\
+			free(heap);																		\
+		}																					\
+	}																						\
+	static void name##__place(name *heap, int slot, name##_entry entry) {					\
+		heap->entries[slot] = entry;														\
+		heap->slot_of[entry.handle] = slot;													\
+	}																						\
+	/* moves entry up from slot, shifting parents down into the hole rather than swapping */	\
+	static void name##__sift_up(name *heap, int slot, name##_entry entry) {				\
+		while (slot > 0) {																	\
+			int parent = (slot - 1) / (arity);												\
+			if (!(before(entry.item, heap->entries[parent].item))) break;					\
+			name##__place(heap, slot, heap->entries[parent]);								\
+			slot = parent;																	\
+		}																					\
+		name##__place(heap, slot, entry);													\
+	}																						\
+	static void name##__sift_down(name *heap, int slot, name##_entry entry) {				\
+		for (;;) {																			\
+			int first = slot * (arity) + 1;													\
+			if (first >= heap->count) break;												\
+			int last = heap->count - first < (arity) ? heap->count : first + (arity);		\
+			int best = first;																\
+			for (int child = first + 1; child < last; child++) {							\
+				if (before(heap->entries[child].item, heap->entries[best].item)) best = child;	\
+			}																				\
+			if (!(before(heap->entries[best].item, entry.item))) break;						\
+			name##__place(heap, slot, heap->entries[best]);									\
+			slot = best;																	\
+		}																					\
+		name##__place(heap, slot, entry);													\
+	}																						\
+	name *name##_heapify(const name##_item *items, int count) {							\
+		name *heap = name##__create(count > HEAP_MIN_CAPACITY ? count : HEAP_MIN_CAPACITY, 0);	\
+		if (!heap) return NULL;																\
+		for (int _ii = 0; _ii < count; _ii++) {												\
+			heap->entries[_ii].item = items[_ii];											\
+			heap->entries[_ii].handle = _ii;												\
+			heap->slot_of[_ii] = _ii;														\
+		}																					\
+		heap->count = count;																\
+		/* floyd's: sift down every parent, last first, which is O(count) overall */		\
+		for (int _ii = count > 1 ? (count - 2) / (arity) : -1; _ii >= 0; _ii--) {			\
+			name##__sift_down(heap, _ii, heap->entries[_ii]);								\
+		}																					\
+		return heap;																		\
+	}																						\
+	static bool name##__grow(name *heap) {													\
+		int capacity = heap->capacity * 2;													\
+		name##_entry *entries = realloc(heap->entries, capacity * sizeof(name##_entry));	\
+		if (!entries) {																		\
+			printf("failed to allocate heap entries");										\
+			return false;																	\
+		}																					\
+		heap->entries = entries;															\
+		int *slot_of = realloc(heap->slot_of, capacity * sizeof(int));						\
+		if (!slot_of) {																		\
+			printf("failed to allocate heap entries");										\
+			return false;																	\
+		}																					\
+		heap->slot_of = slot_of;															\
+		for (int _ii = heap->capacity; _ii < capacity; _ii++) slot_of[_ii] = -1;			\
+		heap->capacity = capacity;															\
+		return true;																		\
+	}																						\
+	/* handles are recycled newest first. with none to recycle every handle below count */	\
+	/* is in use, so count is the next one */												\
+	static int name##__take_handle(name *heap) {											\
+		int handle = heap->free_handle;														\
+		if (handle < 0) return heap->count;													\
+		heap->free_handle = -2 - heap->slot_of[handle];										\
+		return handle;																		\
+	}																						\
+	static void name##__give_handle(name *heap, int handle) {								\
+		heap->slot_of[handle] = -2 - heap->free_handle;										\
+		heap->free_handle = handle;															\
+	}																						\
+	/* adds item, or on a full bounded heap swaps it for the top if it comes out later */	\
+	static int name##__add(name *heap, item_t item, item_t *dropped, bool *was_dropped) {	\
+		*was_dropped = false;																\
+		if (heap->bound && heap->count == heap->bound) {									\
+			*was_dropped = true;															\
+			if (!(before(heap->entries[0].item, item))) {									\
+				if (dropped) *dropped = item;												\
+				return HEAP_NO_HANDLE;														\
+			}																				\
+			name##_entry entry = { item, heap->entries[0].handle };							\
+			if (dropped) *dropped = heap->entries[0].item;									\
+			name##__sift_down(heap, 0, entry);												\
+			return entry.handle;															\
+		}																					\
+		if (heap->count == heap->capacity && !name##__grow(heap)) return HEAP_NO_HANDLE;	\
+		name##_entry entry = { item, name##__take_handle(heap) };							\
+		name##__sift_up(heap, heap->count++, entry);										\
+		return entry.handle;																\
+	}																						\
+	int name##_push(name *heap, item_t item) {												\
+		bool was_dropped;																	\
+		return name##__add(heap, item, NULL, &was_dropped);									\
+	}																						\
+	bool name##_offer(name *heap, item_t item, item_t *dropped) {							\
+		bool was_dropped;																	\
+		name##__add(heap, item, dropped, &was_dropped);										\
+		return was_dropped;																	\
+	}																						\
+	item_t *name##_top(name *heap) {														\
+		return heap->count ? &heap->entries[0].item : NULL;									\
+	}																						\
+	item_t *name##_get(name *heap, int handle) {											\
+		if (handle < 0 || handle >= heap->capacity || heap->slot_of[handle] < 0) return NULL;	\
+		return &heap->entries[heap->slot_of[handle]].item;									\
+	}																						\
+	bool name##_rem(name *heap, int handle, item_t *out) {									\
+		if (!name##_get(heap, handle)) return false;										\
+		int slot = heap->slot_of[handle];													\
+		if (out) *out = heap->entries[slot].item;											\
+		name##_entry last = heap->entries[--heap->count];									\
+		if (slot < heap->count) {															\
+			/* the last entry fills the hole, and goes whichever way it belongs */			\
+			if (before(last.item, heap->entries[slot].item)) {								\
+				name##__sift_up(heap, slot, last);											\
+			}																				\
+			else {																			\
+				name##__sift_down(heap, slot, last);										\
+			}																				\
+		}																					\
+		name##__give_handle(heap, handle);													\
+		return true;																		\
+	}																						\
+	bool name##_pop(name *heap, item_t *out) {												\
+		if (!heap->count) return false;														\
+		name##_entry top = heap->entries[0];												\
+		if (out) *out = top.item;															\
+		name##_entry last = heap->entries[--heap->count];									\
+		if (heap->count) name##__sift_down(heap, 0, last);									\
+		name##__give_handle(heap, top.handle);												\
+		return true;																		\
+	}																						\
+	bool name##_update(name *heap, int handle, item_t item) {								\
+		item_t *old = name##_get(heap, handle);												\
+		if (!old) return false;																\
+		name##_entry entry = { item, handle };												\
+		if (before(item, *old)) {															\
+			name##__sift_up(heap, heap->slot_of[handle], entry);							\
+		}																					\
+		else {																				\
+			name##__sift_down(heap, heap->slot_of[handle], entry);							\
+		}																					\
+		return true;																		\
+	}																						\
+	typedef int name##__defined
+
+/**
+* @brief		run code with every item in a heap
+* @details		items are visited in the heap's array order, which is only partly sorted
+*				(the top comes first). don't push, pop or update inside run.
+* @note         the variable name _ii can not be used with this function
+*
+* @param[in]	item_t - the item type of the heap
+* @param[in]	heap_item - your chosen variable name for the current item
+* @param[in]	heap   - the heap you're itterating through
+* @param[in]	run    - the code you would like to run. this can be multiple lines long
+*/
+#define HEAP_FOREACH(item_t, heap_item, heap, run)													\
+do {																						\
+	if (heap) {																				\
+		for (int _ii = 0; _ii < (heap)->count; _ii++) {										\
+			item_t heap_item = (heap)->entries[_ii].item;									\
+			run;																			\
+		}																					\
+	}																						\
+} while (0)
+
+/**
+* @brief		returns the number of items in a heap
+*
+* @param[in]	heap - the heap you're querying the size of
+* @return		the number of items stored
+*/
+#define HEAP_SIZE(heap) ((heap) ? (heap)->count : 0)
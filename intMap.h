@@ -0,0 +1,229 @@
+//---------------------------------------------------------
+// file:    intMap.h
+// author:  Jordan Hoffmann
+// brief:   Library for integer keyed hash maps generated per type
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// capacity of a map made with name_create()
+#define INTMAP_MIN_CAPACITY 8
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		declares an integer keyed map type and its functions
+* @details		keys can be any integer or pointer type (uint32_t, uint64_t, void *, ...).
+*				keys and values are stored inline in one open addressed slot array,
+*				so a put never allocates unless the map grows, and nothing is converted to a string.
+*				put this in a header, and INTMAP_DEFINE with the same arguments in one .c file.
+*
+*				generates:
+*				name   *name_create(void);
+*				name   *name_create_cap(int capacity);
+*				void    name_free(name *map);
+*				void    name_put(name *map, key_t key, val_t val);	(adds or replaces, unless full and it can't grow)
+*				val_t  *name_find(name *map, key_t key);			(NULL if the key isn't there)
+*				bool    name_exists(name *map, key_t key);
+*				bool    name_rem(name *map, key_t key);				(false if the key isn't there)
+*
+* @param[in]	name  - the name of the map type, also used as the prefix of its functions
+* @param[in]	key_t - the integer or pointer type of the keys
+* @param[in]	val_t - the type of the values
+*/
+#define INTMAP_DECLARE(name, key_t, val_t)													\
+	typedef struct {																		\
+		key_t key;																			\
+		val_t val;																			\
+		bool used;																			\
+	} name##_slot;																			\
+	typedef struct {																		\
+		int count;				/* number of keys stored					*/				\
+		int capacity;			/* number of slots (always a power of 2)	*/				\
+		name##_slot *slots;		/* open addressed slot array				*/				\
+	} name;																					\
+	name *name##_create(void);																\
+	name *name##_create_cap(int capacity);													\
+	void name##_free(name *map);															\
+	void name##_put(name *map, key_t key, val_t val);										\
+	val_t *name##_find(name *map, key_t key);												\
+	bool name##_exists(name *map, key_t key);												\
+	bool name##_rem(name *map, key_t key)
+
+/**
+* @brief		defines the functions declared by INTMAP_DECLARE
+* @details		use exactly once per map type, in a .c file that has seen INTMAP_DECLARE.
+*				collisions are resolved with linear probing and removal shifts later keys back,
+*				so there are no tombstones to clean up.
+*
+* @param[in]	name  - the same name given to INTMAP_DECLARE
+* @param[in]	key_t - the same key type given to INTMAP_DECLARE
+* @param[in]	val_t - the same value type given to INTMAP_DECLARE
+*/
+#define INTMAP_DEFINE(name, key_t, val_t)													\
+	static unsigned name##__index(name *map, key_t key) {									\
+		return (unsigned)__intmap_hash(&key, sizeof(key_t)) & (map->capacity - 1);			\
+	}																						\
+	name *name##_create_cap(int capacity) {													\
+		int cap = INTMAP_MIN_CAPACITY;														\
+		while (cap * 7 < capacity * 10) cap *= 2;											\
+		name *map = malloc(sizeof(name));													\
+		if (!map) {																			\
+			printf("failed to allocate int map");											\
+			return NULL;																	\
+		}																					\
+		map->count = 0;																		\
+		map->capacity = cap;																\
+		map->slots = calloc(cap, sizeof(name##_slot));										\
+		if (!map->slots) printf("failed to allocate int map slots");						\
+		return map;																			\
+	}																						\
+	name *name##_create(void) {																\
+		return name##_create_cap(0);														\
+	}																						\
+	void name##_free(name *map) {															\
+		if (map) {																			\
+			free(map->slots);																\
+			free(map);																		\
+		}																					\
+	}																						\
+	/* false (leaving the map as it was) if the bigger slot array couldn't be allocated */	\
+	static bool name##__grow(name *map) {													\
+		name##_slot *old_slots = map->slots;												\
+		int old_capacity = map->capacity;													\
+		map->capacity *= 2;																	\
+		map->slots = calloc(map->capacity, sizeof(name##_slot));							\
+		if (!map->slots) {																	\
+			printf("failed to allocate int map slots");										\
+			map->slots = old_slots;															\
+			map->capacity = old_capacity;													\
+			return false;																	\
+		}																					\
+		for (int _ii = 0; _ii < old_capacity; _ii++) {										\
+			if (old_slots[_ii].used) {														\
+				unsigned idx = name##__index(map, old_slots[_ii].key);						\
+				while (map->slots[idx].used) idx = (idx + 1) & (map->capacity - 1);			\
+				map->slots[idx] = old_slots[_ii];											\
+			}																				\
+		}																					\
+		free(old_slots);																	\
+		return true;																		\
+	}																						\
+	void name##_put(name *map, key_t key, val_t val) {										\
+		if ((map->count + 1) * 10 > map->capacity * 7 && !name##__grow(map)) {				\
+			/* probes stop at an empty slot, so the last one is never filled */				\
+			if (map->count + 1 >= map->capacity) return;									\
+		}																					\
+		unsigned idx = name##__index(map, key);												\
+		while (map->slots[idx].used) {														\
+			if (map->slots[idx].key == key) {												\
+				map->slots[idx].val = val;													\
+				return;																		\
+			}																				\
+			idx = (idx + 1) & (map->capacity - 1);											\
+		}																					\
+		map->slots[idx].key = key;															\
+		map->slots[idx].val = val;															\
+		map->slots[idx].used = true;														\
+		map->count++;																		\
+	}																						\
+	val_t *name##_find(name *map, key_t key) {												\
+		unsigned idx = name##__index(map, key);												\
+		while (map->slots[idx].used) {														\
+			if (map->slots[idx].key == key) return &map->slots[idx].val;					\
+			idx = (idx + 1) & (map->capacity - 1);											\
+		}																					\
+		return NULL;																		\
+	}																						\
+	bool name##_exists(name *map, key_t key) {												\
+		return name##_find(map, key) != NULL;												\
+	}																						\
+	bool name##_rem(name *map, key_t key) {													\
+		unsigned mask = map->capacity - 1;													\
+		unsigned idx = name##__index(map, key);												\
+		while (map->slots[idx].used && map->slots[idx].key != key) idx = (idx + 1) & mask;	\
+		if (!map->slots[idx].used) return false;											\
+		/* shift back every later key that would otherwise be cut off from its home */		\
+		unsigned next = (idx + 1) & mask;													\
+		while (map->slots[next].used) {														\
+			unsigned home = name##__index(map, map->slots[next].key);						\
+			if (((next - home) & mask) >= ((next - idx) & mask)) {							\
+				map->slots[idx] = map->slots[next];											\
+				idx = next;																	\
+			}																				\
+			next = (next + 1) & mask;														\
+		}																					\
+		map->slots[idx].used = false;														\
+		map->count--;																		\
+		return true;																		\
+	}																						\
+	typedef int name##__defined
+
+/**
+* @brief		run code with every key and value in an int map
+* @details		order is unspecified. don't add or remove keys inside run.
+* @note         the variable name _ii can not be used with this function
+*
+* @param[in]	key_t - the key type of the map
+* @param[in]	val_t - the value type of the map
+* @param[in]	key_item - your chosen variable name for the current key
+* @param[in]	val_item - your chosen variable name for the current value
+* @param[in]	map   - the map you're itterating through
+* @param[in]	run   - the code you would like to run. this can be multiple lines long
+*/
+#define INTMAP_FOREACH(key_t, val_t, key_item, val_item, map, run)								\
+do {																						\
+	if (map) {																				\
+		for (int _ii = 0; _ii < (map)->capacity; _ii++) {									\
+			if ((map)->slots[_ii].used) {													\
+				key_t key_item = (map)->slots[_ii].key;										\
+				val_t val_item = (map)->slots[_ii].val;										\
+				run;																		\
+			}																				\
+		}																					\
+	}																						\
+} while (0)
+
+/**
+* @brief		returns the number of keys in an int map
+*
+* @param[in]	map - the map you're querying the size of
+* @return		the number of keys stored
+*/
+#define INTMAP_SIZE(map) ((map) ? (map)->count : 0)
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ignore these helper functions
+
+// mixes the bytes of an integer or pointer key (murmur3 finalizers)
+static inline uint64_t __intmap_hash(const void *key, size_t key_size) {
+	if (key_size <= sizeof(uint32_t)) {
+		uint32_t h = 0;
+		memcpy(&h, key, key_size);
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return h;
+	}
+	uint64_t h = 0;
+	memcpy(&h, key, key_size < sizeof(uint64_t) ? key_size : sizeof(uint64_t));
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
+}
@@ -19,6 +19,13 @@
 // Private Structures:
 //---------------------------------------------------------
 
+// what a node removed with an _epoch function needs to be freed into its list's allocator
+typedef struct {
+	void *node;						// the unlinked node
+	Allocator *allocator;			// the allocator the node and its element came from
+	void(*free_func)(void *);		// called on the element
+} _LinkRetired;
+
 //---------------------------------------------------------
 // Public Variables:
 //---------------------------------------------------------
@@ -30,27 +37,41 @@
 //---------------------------------------------------------
 // Private Function Declarations:
 //---------------------------------------------------------
+static void _link_retire_node(LinkedList *list, void *node, void(free_func)(void *), Epoch *epoch);
+static void _link_reclaim_node(void *node, void(free_func)(void *));
+static void _link_reclaim_alloc_node(void *retired, void(free_func)(void *));
+static void _link_reclaim_list(void *list, void(free_func)(void *));
 
 //---------------------------------------------------------
 // Public Functions:
 //---------------------------------------------------------
 
 LinkedList *link_create(LinkedListType type) {
-	LinkedList *new_list = malloc(sizeof(LinkedList));
+	return link_create_alloc(type, NULL);
+}
+
+LinkedList *link_create_alloc(LinkedListType type, Allocator *allocator) {
+	Counters *counters = COUNTERS_CREATE("LinkedList", allocator);
+	allocator = COUNTERS_ALLOCATOR(counters, allocator);
+	LinkedList *new_list = alloc_malloc(allocator, sizeof(LinkedList));
     if (new_list) {
 	    new_list->type = type;
+	    new_list->allocator = allocator;
+	    new_list->counters = counters;
 	    new_list->size = 0;
 	    new_list->head = NULL;
 	    new_list->tail = NULL;
     }
     else {
         printf("failed to allocate linked list");
+        COUNTERS_FREE(counters);
     }
 	return new_list;
 }
 
 LinkedList *link_copy(LinkedList *list) {
-    LinkedList *new_list = link_create(list->type);
+    COUNTERS_OP(list->counters, COUNTERS_COPY);
+    LinkedList *new_list = link_create_alloc(list->type, counters_unwrap(list->allocator));
     if (list->type == SINGLY_LINKED_LIST) {
         sl_node *s = list->head;
         while (s) {
@@ -67,28 +88,37 @@ LinkedList *link_copy(LinkedList *list) {
 }
 
 void link_free(LinkedList *list, void(free_func)(void *)) {
-	if (list && list->size) {
+	if (list && !free_func && alloc_is_region(list->allocator)) {
+		// the region releases every node when it is dropped
+		COUNTERS_FREE(list->counters);
+		return;
+	}
+	Counters *counters = list ? list->counters : NULL;
+	if (list && !list->size) {
+		alloc_free(list->allocator, list);
+	}
+	else if (list) {
 		if (list->type == SINGLY_LINKED_LIST) {
 			sl_node *s = list->head;
 			while (s->next) {
 				if (free_func) {
 					(*free_func)(*(void **)s->data);
 				}
-				free(s->data);
+				alloc_free(list->allocator, s->data);
 				s->data = NULL;
 				sl_node *temp = s;
 				s = s->next;
-				free(temp);
+				alloc_free(list->allocator, temp);
 				temp = NULL;
 			}
 			if (free_func) {
 				(*free_func)(*(void **)s->data);
 			}
-			free(s->data);
+			alloc_free(list->allocator, s->data);
 			s->data = NULL;
-			free(s);
+			alloc_free(list->allocator, s);
 			s = NULL;
-			free(list);
+			alloc_free(list->allocator, list);
 		}
 		else {
 			dl_node *s = list->head;
@@ -98,22 +128,23 @@ void link_free(LinkedList *list, void(free_func)(void *)) {
 					    (*free_func)(*(void **)s->data);
                     }
 				}
-				free(s->data);
+				alloc_free(list->allocator, s->data);
 				s->data = NULL;
 				s = s->next;
-				free(s->prev);
+				alloc_free(list->allocator, s->prev);
 				s->prev = NULL;
 			}
 			if (free_func) {
 				(*free_func)(*(void **)s->data);
 			}
-			free(s->data);
+			alloc_free(list->allocator, s->data);
 			s->data = NULL;
-			free(s);
+			alloc_free(list->allocator, s);
 			s = NULL;
-			free(list);
+			alloc_free(list->allocator, list);
 		}
 	}
+	COUNTERS_FREE(counters);
 }
 
 
@@ -122,10 +153,10 @@ void link_rem_back(LinkedList *list, void(free_func)(void *)) {
 		if (free_func) {
 			void **temp = __link_popBack(list);
 			(*free_func)(*temp);
-			free(temp);
+			alloc_free(list->allocator, temp);
 		}
 		else {
-			free(__link_popBack(list));
+			alloc_free(list->allocator, __link_popBack(list));
 		}
 	}
 }
@@ -135,17 +166,79 @@ void link_rem_front(LinkedList *list, void(free_func)(void *)) {
 		if (free_func) {
 			void **temp = __link_popFront(list);
 			(*free_func)(*temp);
-			free(temp);
+			alloc_free(list->allocator, temp);
 		}
 		else {
-			free(__link_popFront(list));
+			alloc_free(list->allocator, __link_popFront(list));
+		}
+	}
+}
+
+void link_rem_front_epoch(LinkedList *list, void(free_func)(void *), Epoch *epoch) {
+	if (list->size) {
+		COUNTERS_OP(list->counters, COUNTERS_REMOVE);
+		// both node types start with data and next, and readers only ever follow next
+		sl_node *front = list->head;
+		__EPOCH_STORE_PTR(&list->head, front->next);
+		if (list->type == DOUBLY_LINKED_LIST && front->next) {
+			((dl_node *)front->next)->prev = NULL;
+		}
+		if (list->tail == front) {
+			list->tail = NULL;
 		}
+		list->size--;
+		_link_retire_node(list, front, free_func, epoch);
 	}
 }
 
+void link_rem_back_epoch(LinkedList *list, void(free_func)(void *), Epoch *epoch) {
+	if (list->size) {
+		COUNTERS_OP(list->counters, COUNTERS_REMOVE);
+		sl_node *back = list->tail;
+		if (list->size == 1) {
+			__EPOCH_STORE_PTR(&list->head, NULL);
+			list->tail = NULL;
+		}
+		else if (list->type == SINGLY_LINKED_LIST) {
+			sl_node *prev = list->head;
+			while (prev->next != back) {
+				prev = prev->next;
+			}
+			__EPOCH_STORE_PTR(&prev->next, NULL);
+			list->tail = prev;
+		}
+		else {
+			dl_node *prev = ((dl_node *)back)->prev;
+			__EPOCH_STORE_PTR(&prev->next, NULL);
+			list->tail = prev;
+		}
+		list->size--;
+		_link_retire_node(list, back, free_func, epoch);
+	}
+}
+
+void link_free_epoch(LinkedList *list, void(free_func)(void *), Epoch *epoch) {
+	if (list) {
+		epoch_retire(epoch, list, _link_reclaim_list, free_func);
+	}
+}
+
+void link_free_async(LinkedList *list, void(free_func)(void *), Reclaimer *reclaimer) {
+	if (!list) {
+		return;
+	}
+	if (!free_func && alloc_is_region(list->allocator)) {
+		// nothing to visit, so there is nothing to hand over either
+		link_free(list, NULL);
+		return;
+	}
+	reclaimer_retire(reclaimer, list, _link_reclaim_list, free_func);
+}
+
 void __link_pushFront(LinkedList *list, void* data_ptr) {
+	COUNTERS_OP(list->counters, COUNTERS_ADD);
 	if (list->type == SINGLY_LINKED_LIST) {
-		sl_node *newNode = malloc(sizeof(sl_node));
+		sl_node *newNode = alloc_malloc(list->allocator, sizeof(sl_node));
         if (newNode) {
 		    newNode->data = data_ptr;
 		    if (list->size == 0) {
@@ -155,12 +248,13 @@ void __link_pushFront(LinkedList *list, void* data_ptr) {
 		    else {
 			    newNode->next = list->head;
 		    }
-		    list->head = newNode;
+		    // the node is finished before it is linked, for epoch readers
+		    __EPOCH_STORE_PTR(&list->head, newNode);
         }
         else printf("failed to allocate linked list node");
 	}
 	else {
-		dl_node *newNode = malloc(sizeof(dl_node));
+		dl_node *newNode = alloc_malloc(list->allocator, sizeof(dl_node));
         if (newNode) {
 		    newNode->data = data_ptr;
             newNode->prev = NULL;
@@ -172,7 +266,7 @@ void __link_pushFront(LinkedList *list, void* data_ptr) {
 			    newNode->next = list->head;
 			    ((dl_node *)list->head)->prev = newNode;
 		    }
-		    list->head = newNode;
+		    __EPOCH_STORE_PTR(&list->head, newNode);
         }
         else printf("failed to allocate linked list node");
 	}
@@ -181,29 +275,30 @@ void __link_pushFront(LinkedList *list, void* data_ptr) {
 
 
 void __link_pushBack(LinkedList *list, void* data_ptr) {
+	COUNTERS_OP(list->counters, COUNTERS_ADD);
 	if (list->type == SINGLY_LINKED_LIST) {
-		sl_node *newNode = malloc(sizeof(sl_node));
+		sl_node *newNode = alloc_malloc(list->allocator, sizeof(sl_node));
 		newNode->data = data_ptr;
 		newNode->next = NULL;
 		if (list->size == 0) {
-			list->head = newNode;
+			__EPOCH_STORE_PTR(&list->head, newNode);
 		}
 		else {
-			((sl_node *)list->tail)->next = newNode;
+			__EPOCH_STORE_PTR(&((sl_node *)list->tail)->next, newNode);
 		}
 		list->tail = newNode;
 	}
 	else {
-		dl_node *newNode = malloc(sizeof(dl_node));
+		dl_node *newNode = alloc_malloc(list->allocator, sizeof(dl_node));
 		newNode->data = data_ptr;
 		newNode->next = NULL;
 		if (list->size == 0) {
-			list->head = newNode;
 			newNode->prev = NULL;
+			__EPOCH_STORE_PTR(&list->head, newNode);
 		}
 		else {
 			newNode->prev = list->tail;
-			((dl_node *)list->tail)->next = newNode;
+			__EPOCH_STORE_PTR(&((dl_node *)list->tail)->next, newNode);
 		}
 		list->tail = newNode;
 	}
@@ -213,20 +308,26 @@ void __link_pushBack(LinkedList *list, void* data_ptr) {
 
 void* __link_popFront(LinkedList *list) {
 	if (list->size) {
+		COUNTERS_OP(list->counters, COUNTERS_REMOVE);
 		void *output;
 		if (list->type == SINGLY_LINKED_LIST) {
 			sl_node *temp = list->head;
 			output = temp->data;
 			list->head = temp->next;
-			free(temp);
+			alloc_free(list->allocator, temp);
 			temp = NULL;
 		}
 		else {
 			dl_node *temp = list->head;
 			output = temp->data;
 			list->head = temp->next;
-			temp->next->prev = NULL;
-			free(temp);
+			if (temp->next) {
+				temp->next->prev = NULL;
+			}
+			else {
+				list->tail = NULL;
+			}
+			alloc_free(list->allocator, temp);
 			temp = NULL;
 		}
 		list->size--;
@@ -237,15 +338,24 @@ void* __link_popFront(LinkedList *list) {
 
 void* __link_popBack(LinkedList *list) {
 	if (list->size) {
+		COUNTERS_OP(list->counters, COUNTERS_REMOVE);
 		void *output;
-		if (list->type == SINGLY_LINKED_LIST) {
+		if (list->size == 1) {
+			// the only node is both ends, with nothing before it to unlink from
+			sl_node *temp = list->head;
+			output = temp->data;
+			list->head = NULL;
+			list->tail = NULL;
+			alloc_free(list->allocator, temp);
+		}
+		else if (list->type == SINGLY_LINKED_LIST) {
 			sl_node *temp = list->head;
 			while (temp->next != list->tail) {
 				temp = temp->next;
 			}
 			output = temp->next->data;
 			list->tail = temp;
-			free(temp->next);
+			alloc_free(list->allocator, temp->next);
 			temp->next = NULL;
 		}
 		else {
@@ -253,7 +363,7 @@ void* __link_popBack(LinkedList *list) {
 			output = temp->data;
 			list->tail = temp->prev;
 			temp->prev->next = NULL;
-			free(temp);
+			alloc_free(list->allocator, temp);
 			temp = NULL;
 		}
 		list->size--;
@@ -262,6 +372,70 @@ void* __link_popBack(LinkedList *list) {
 	else return NULL;
 }
 
+void *__link_alloc(LinkedList *list, size_t size) {
+	return alloc_malloc(list->allocator, size);
+}
+
 //---------------------------------------------------------
 // Private Functions:
 //---------------------------------------------------------
+
+// hands an unlinked node to the epoch. nodes from an allocator carry it along in a
+// _LinkRetired, which comes from the same allocator
+static void _link_retire_node(LinkedList *list, void *node, void(free_func)(void *), Epoch *epoch) {
+	if (!list->allocator) {
+		epoch_retire(epoch, node, _link_reclaim_node, free_func);
+		return;
+	}
+	_LinkRetired *retired = alloc_malloc(list->allocator, sizeof(_LinkRetired));
+	if (retired) {
+		retired->node = node;
+		retired->allocator = list->allocator;
+		retired->free_func = free_func;
+		// the list may be freed before the epoch gets to this node
+		COUNTERS_HOLD(list->allocator);
+		epoch_retire(epoch, retired, _link_reclaim_alloc_node, NULL);
+	}
+	else {
+		// nowhere to keep the allocator, so wait out the readers and give the node back now.
+		// it didn't come from malloc, so _link_reclaim_node can't free it
+		printf("failed to allocate retired node");
+		epoch_synchronize(epoch);
+		void *data = ((sl_node *)node)->data;
+		if (free_func) {
+			(*free_func)(*(void **)data);
+		}
+		alloc_free(list->allocator, data);
+		alloc_free(list->allocator, node);
+	}
+}
+
+// frees a node unlinked by one of the _epoch removes, along with its element
+static void _link_reclaim_node(void *node, void(free_func)(void *)) {
+	void *data = ((sl_node *)node)->data;
+	if (free_func) {
+		(*free_func)(*(void **)data);
+	}
+	free(data);
+	free(node);
+}
+
+// frees a node removed by _link_retire_node into the allocator it came from
+static void _link_reclaim_alloc_node(void *retired, void(free_func)(void *)) {
+	// the free_func passed at retire time travels in the _LinkRetired
+	(void)free_func;
+	_LinkRetired *r = retired;
+	Allocator *allocator = r->allocator;
+	void *data = ((sl_node *)r->node)->data;
+	if (r->free_func) {
+		(*r->free_func)(*(void **)data);
+	}
+	alloc_free(allocator, data);
+	alloc_free(allocator, r->node);
+	alloc_free(allocator, r);
+	COUNTERS_RELEASE(allocator);
+}
+
+static void _link_reclaim_list(void *list, void(free_func)(void *)) {
+	link_free(list, free_func);
+}
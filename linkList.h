@@ -5,6 +5,10 @@
 //---------------------------------------------------------
 
 #pragma once
+#include "epoch.h"
+#include "allocator.h"
+#include "reclaimer.h"
+#include "counters.h"
 
 //---------------------------------------------------------
 // Private Consts:
@@ -23,6 +27,8 @@ typedef struct {
 	LinkedListType type;	// Determines how the list's data is organized
 	void *head;				// head node of the linked list
 	void *tail;				// tail node of the linked list
+	Allocator *allocator;	// where nodes and elements come from (or NULL for malloc)
+	Counters *counters;		// allocations and operations, with DS_ENABLE_COUNTERS (or NULL)
 } LinkedList;
 
 typedef struct sl_node {
@@ -52,6 +58,18 @@ typedef struct dl_node {
 */
 LinkedList *link_create(LinkedListType type);
 
+/**
+* @brief		Allocates and initializes a new LinkedList ptr that gets its memory from an allocator
+* @details		the list, its nodes and every element pushed to it come from allocator, which
+*				has to outlive the list. a pool_allocator fits well, since every node is the same size.
+*				with the _epoch removes, only writers use the allocator.
+*
+* @param[in]	type	  - either DOUBLY_LINKED_LIST, or SINGLY_LINKED_LIST (this will effect performance)
+* @param[in]	allocator - the allocator to use, i.e pool_allocator(pool). NULL uses malloc
+* @return		a pointer to a newly allocated and empty linked list
+*/
+LinkedList *link_create_alloc(LinkedListType type, Allocator *allocator);
+
 /**
 * @brief		Allocates and initializes a copy of another linked list
 *
@@ -63,7 +81,8 @@ LinkedList *link_copy(LinkedList *list);
 /**
 * @brief		completely frees a linked list and its elements
 * @details		set free_func to NULL if your data is either not pointers
-*				or you wish to not free it.
+*				or you wish to not free it. on a region allocator (i.e an arena) with no
+*				free_func, this returns right away and the region gets the nodes back.
 *
 * @param[in]	list	 - the linked list you wish to free
 * @param[in]	freeFunc - function to call on all the elements in the list
@@ -90,6 +109,50 @@ void link_rem_back(LinkedList *list, void(free_func)(void *));
 */
 void link_rem_front(LinkedList *list, void(free_func)(void *));
 
+/**
+* @brief		removes the first element of a linked list that other threads are reading
+* @details		readers walk the list with LINK_FOREACH between epoch_enter and epoch_exit.
+*				the element is unlinked right away, but it is only freed (with free_func, like
+*				link_rem_front) once every reader that could have reached it has left.
+*				pushes are safe to do while reading too. writers still need a lock of their own.
+*
+* @param[in]	list	 - the linked list you wish to remove from
+* @param[in]	freeFunc - function to call on the element being removed
+* @param[in]	epoch	 - the epoch the list's readers enter
+*/
+void link_rem_front_epoch(LinkedList *list, void(free_func)(void *), Epoch *epoch);
+
+/**
+* @brief		removes the last element of a linked list that other threads are reading
+* @details		see link_rem_front_epoch. (this is slow for singly linked lists)
+*
+* @param[in]	list	 - the linked list you wish to remove from
+* @param[in]	freeFunc - function to call on the element being removed
+* @param[in]	epoch	 - the epoch the list's readers enter
+*/
+void link_rem_back_epoch(LinkedList *list, void(free_func)(void *), Epoch *epoch);
+
+/**
+* @brief		frees a linked list and its elements once no reader can still be walking it
+* @details		take the list out of wherever readers find it first.
+*
+* @param[in]	list	 - the linked list you wish to free
+* @param[in]	freeFunc - function to call on all the elements in the list
+* @param[in]	epoch	 - the epoch the list's readers enter
+*/
+void link_free_epoch(LinkedList *list, void(free_func)(void *), Epoch *epoch);
+
+/**
+* @brief		frees a linked list and its elements on a reclaimer's thread
+* @details		the list is handed over in O(1) and link_free runs later on the reclaimer's
+*				thread. free_func, and the list's allocator (unless it's a region), run there too.
+*
+* @param[in]	list	  - the linked list you wish to free. don't use it after this
+* @param[in]	freeFunc  - function to call on all the elements in the list
+* @param[in]	reclaimer - the reclaimer that frees the list
+*/
+void link_free_async(LinkedList *list, void(free_func)(void *), Reclaimer *reclaimer);
+
 /**
 * @brief		pushes an element to the front of a linked list
 * @details		
@@ -98,9 +161,9 @@ void link_rem_front(LinkedList *list, void(free_func)(void *));
 * @param[in]	list   - the linked list you wish to push to
 * @param[in]	val	   - the data you wish to push
 */
-#define LINK_PUSH_FRONT(type_t, list, val);			\
+#define LINK_PUSH_FRONT(type_t, list, val)			\
 	do {											\
-		type_t *data_ptr = malloc(sizeof(type_t));	\
+		type_t *data_ptr = (type_t *)__link_alloc(list, sizeof(type_t));	\
 		*data_ptr = val;							\
 		__link_pushFront(list, data_ptr);			\
 	} while (0)
@@ -113,9 +176,9 @@ void link_rem_front(LinkedList *list, void(free_func)(void *));
 * @param[in]	list   - the linked list you wish to push to
 * @param[in]	val	   - the data you wish to push
 */
-#define LINK_PUSH_BACK(type_t, list, val);			\
+#define LINK_PUSH_BACK(type_t, list, val)			\
 	do {											\
-		type_t *data_ptr = malloc(sizeof(type_t));	\
+		type_t *data_ptr = (type_t *)__link_alloc(list, sizeof(type_t));	\
 		*data_ptr = val;							\
 		__link_pushBack(list, data_ptr);			\
 	} while (0)
@@ -143,6 +206,7 @@ void link_rem_front(LinkedList *list, void(free_func)(void *));
 /**
 * @brief		run code with every element in a linked list
 * @details		(ask jordan for an example)
+*				safe inside an epoch read section while another thread pushes or uses the _epoch removes
 *
 * @param[in]	type_t - the type of data being accessed. i.e (int), (double *), etc.
 * @param[in]	item   - your chosen variable name for the current item in the list
@@ -151,25 +215,25 @@ void link_rem_front(LinkedList *list, void(free_func)(void *));
 */
 #define LINK_FOREACH(type_t, item, list, run)					\
 do {															\
-	if(list && LINK_SIZE(list)) {								\
+	if(list) {													\
 		if(list->type == SINGLY_LINKED_LIST) {					\
-			sl_node *_ii = list->head;							\
+			sl_node *_ii = __EPOCH_LOAD_PTR(&list->head);		\
 			while (_ii) {										\
                 if(_ii->data) {                                 \
 				    type_t item = *(type_t *)_ii->data;			\
 				    run;										\
                 }                                               \
-				_ii = _ii->next;								\
+				_ii = __EPOCH_LOAD_PTR(&_ii->next);				\
 			}													\
 		}														\
 		else {													\
-			dl_node *_ii = list->head;							\
+			dl_node *_ii = __EPOCH_LOAD_PTR(&list->head);		\
 			while (_ii) {										\
                 if(_ii->data) {                                 \
 				    type_t item = *(type_t *)_ii->data;		    \
 				    run;									    \
                 }                                               \
-				_ii = _ii->next;								\
+				_ii = __EPOCH_LOAD_PTR(&_ii->next);				\
 			}													\
 		}														\
 	}															\
@@ -190,3 +254,4 @@ void __link_pushFront(LinkedList *list, void* data_ptr);
 void __link_pushBack(LinkedList *list, void* data_ptr);
 void* __link_popFront(LinkedList *list);
 void* __link_popBack(LinkedList *list);
+void *__link_alloc(LinkedList *list, size_t size);
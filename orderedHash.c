@@ -0,0 +1,277 @@
+//---------------------------------------------------------
+// file:    orderedHash.c
+// author:  Jordan Hoffmann
+// brief:   Library for compact hash tables that remember insertion order
+//---------------------------------------------------------
+
+#include "orderedHash.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static unsigned default_hash(unsigned char *key, int key_len);
+static int _ohash_index_size_for(int count);
+static int _ohash_find_slot(OrderedHash *map, unsigned char *key, int key_len, unsigned hash);
+static void _ohash_index_insert(OrderedHash *map, unsigned hash, int pos);
+static void _ohash_rebuild_index(OrderedHash *map, int index_size);
+static void _ohash_pack(OrderedHash *map);
+static void _ohash_resize_entries(OrderedHash *map, int capacity);
+static int _ohash_store_key(OrderedHash *map, unsigned char *key, int key_len);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+OrderedHash *ohash_create(unsigned(hash_func)(unsigned char *, int), int value_size) {
+	assert(value_size >= 0);
+	OrderedHash *map = malloc(sizeof(OrderedHash));
+	if (!map) {
+		printf("failed to allocate ordered hash table");
+		return NULL;
+	}
+	map->count = 0;
+	map->used = 0;
+	map->capacity = 0;
+	map->value_size = value_size;
+	map->entries = NULL;
+	map->values = NULL;
+	map->keys = NULL;
+	map->keys_used = 0;
+	map->keys_capacity = 0;
+	map->index = NULL;
+	map->index_size = 0;
+	map->hash_func = hash_func ? hash_func : default_hash;
+	_ohash_resize_entries(map, OHASH_MIN_CAPACITY);
+	_ohash_rebuild_index(map, _ohash_index_size_for(OHASH_MIN_CAPACITY));
+	return map;
+}
+
+void ohash_free(OrderedHash *map, void(free_func)(void *)) {
+	if (!map) {
+		return;
+	}
+	if (free_func) {
+		for (int i = 0; i < map->used; i++) {
+			if (map->entries[i].key_len >= 0) {
+				(*free_func)(*(void **)(map->values + (size_t)i * map->value_size));
+			}
+		}
+	}
+	free(map->entries);
+	free(map->values);
+	free(map->keys);
+	free(map->index);
+	free(map);
+}
+
+void ohash_put(OrderedHash *map, unsigned char *key, int key_len, void *val, void(free_func)(void *)) {
+	unsigned hash = (*map->hash_func)(key, key_len);
+	int slot = _ohash_find_slot(map, key, key_len, hash);
+	if (slot >= 0) {
+		void *old = map->values + (size_t)map->index[slot] * map->value_size;
+		if (free_func) {
+			(*free_func)(*(void **)old);
+		}
+		memcpy(old, val, map->value_size);
+		return;
+	}
+
+	// removed entries still hold their index slot, so packing them out may be enough room
+	if ((map->used + 1) * 10 > map->index_size * 7) {
+		_ohash_pack(map);
+		int index_size = _ohash_index_size_for(map->count + 1);
+		_ohash_rebuild_index(map, index_size > map->index_size ? index_size : map->index_size);
+	}
+	if (map->used == map->capacity) {
+		_ohash_resize_entries(map, map->capacity * 2);
+	}
+	int pos = map->used++;
+	map->entries[pos].hash = hash;
+	map->entries[pos].key_len = key_len;
+	map->entries[pos].key_off = _ohash_store_key(map, key, key_len);
+	memcpy(map->values + (size_t)pos * map->value_size, val, map->value_size);
+	_ohash_index_insert(map, hash, pos);
+	map->count++;
+}
+
+void *ohash_get(OrderedHash *map, unsigned char *key, int key_len) {
+	unsigned hash = (*map->hash_func)(key, key_len);
+	int slot = _ohash_find_slot(map, key, key_len, hash);
+	if (slot < 0) {
+		return NULL;
+	}
+	return map->values + (size_t)map->index[slot] * map->value_size;
+}
+
+bool ohash_exists(OrderedHash *map, unsigned char *key, int key_len) {
+	return ohash_get(map, key, key_len) != NULL;
+}
+
+bool ohash_rem(OrderedHash *map, unsigned char *key, int key_len, void(free_func)(void *)) {
+	unsigned hash = (*map->hash_func)(key, key_len);
+	int slot = _ohash_find_slot(map, key, key_len, hash);
+	if (slot < 0) {
+		return false;
+	}
+	int pos = map->index[slot];
+	if (free_func) {
+		(*free_func)(*(void **)(map->values + (size_t)pos * map->value_size));
+	}
+	map->index[slot] = OHASH_REMOVED;
+	map->entries[pos].key_len = -1;
+	map->count--;
+
+	// keep iteration from wading through more removed entries than live ones
+	if (map->used > OHASH_MIN_CAPACITY && map->used - map->count > map->count) {
+		_ohash_pack(map);
+		_ohash_rebuild_index(map, map->index_size);
+	}
+	return true;
+}
+
+void ohash_compact(OrderedHash *map) {
+	_ohash_pack(map);
+	int capacity = map->count > OHASH_MIN_CAPACITY ? map->count : OHASH_MIN_CAPACITY;
+	_ohash_resize_entries(map, capacity);
+	if (map->keys_used < map->keys_capacity) {
+		unsigned char *keys = realloc(map->keys, map->keys_used ? map->keys_used : 1);
+		if (keys) {
+			map->keys = keys;
+			map->keys_capacity = map->keys_used ? map->keys_used : 1;
+		}
+	}
+	_ohash_rebuild_index(map, _ohash_index_size_for(capacity));
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// FNV-1a, the same as HashTable's default
+static unsigned default_hash(unsigned char *key, int key_len) {
+	unsigned h = 2166136261u;
+	for (int i = 0; i < key_len; i++) {
+		h ^= key[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+// smallest power of 2 that keeps count slots at most 70% full
+static int _ohash_index_size_for(int count) {
+	int index_size = OHASH_MIN_CAPACITY;
+	while (index_size * 7 < count * 10) {
+		index_size *= 2;
+	}
+	return index_size;
+}
+
+// returns the index slot of the entry holding key, or -1 if there isn't one
+static int _ohash_find_slot(OrderedHash *map, unsigned char *key, int key_len, unsigned hash) {
+	unsigned mask = map->index_size - 1;
+	unsigned slot = hash & mask;
+	while (map->index[slot] != OHASH_EMPTY) {
+		int pos = map->index[slot];
+		if (pos >= 0) {
+			_OHashEntry *entry = &map->entries[pos];
+			if (entry->hash == hash && entry->key_len == key_len &&
+				memcmp(map->keys + entry->key_off, key, key_len) == 0) {
+				return (int)slot;
+			}
+		}
+		slot = (slot + 1) & mask;
+	}
+	return -1;
+}
+
+// puts an entry position in the first free slot of its probe sequence
+static void _ohash_index_insert(OrderedHash *map, unsigned hash, int pos) {
+	unsigned mask = map->index_size - 1;
+	unsigned slot = hash & mask;
+	while (map->index[slot] >= 0) {
+		slot = (slot + 1) & mask;
+	}
+	map->index[slot] = pos;
+}
+
+// replaces the index with one of index_size slots holding every live entry
+static void _ohash_rebuild_index(OrderedHash *map, int index_size) {
+	free(map->index);
+	map->index_size = index_size;
+	map->index = malloc(index_size * sizeof(int));
+	if (!map->index) {
+		printf("failed to allocate ordered hash index");
+		return;
+	}
+	for (int i = 0; i < index_size; i++) {
+		map->index[i] = OHASH_EMPTY;
+	}
+	for (int i = 0; i < map->used; i++) {
+		if (map->entries[i].key_len >= 0) {
+			_ohash_index_insert(map, map->entries[i].hash, i);
+		}
+	}
+}
+
+// slides live entries, values and keys down over removed ones, keeping their order.
+// the index is left pointing at old positions, so callers rebuild it afterwards
+static void _ohash_pack(OrderedHash *map) {
+	if (map->used == map->count) {
+		return;
+	}
+	int pos = 0;
+	int keys_used = 0;
+	for (int i = 0; i < map->used; i++) {
+		_OHashEntry entry = map->entries[i];
+		if (entry.key_len < 0) {
+			continue;
+		}
+		// keys were appended in entry order, so a key never moves past one still to be read
+		memmove(map->keys + keys_used, map->keys + entry.key_off, entry.key_len + 1);
+		entry.key_off = keys_used;
+		keys_used += entry.key_len + 1;
+		if (pos != i) {
+			memcpy(map->values + (size_t)pos * map->value_size, map->values + (size_t)i * map->value_size, map->value_size);
+		}
+		map->entries[pos++] = entry;
+	}
+	map->used = pos;
+	map->keys_used = keys_used;
+}
+
+// reallocates the entry and value arrays to hold capacity entries
+static void _ohash_resize_entries(OrderedHash *map, int capacity) {
+	_OHashEntry *entries = realloc(map->entries, capacity * sizeof(_OHashEntry));
+	unsigned char *values = realloc(map->values, (size_t)capacity * map->value_size + 1);
+	if (!entries || !values) {
+		printf("failed to allocate ordered hash entries");
+	}
+	if (entries) map->entries = entries;
+	if (values) map->values = values;
+	map->capacity = capacity;
+}
+
+// appends a '\0' terminated copy of key to the key bytes and returns where it starts
+static int _ohash_store_key(OrderedHash *map, unsigned char *key, int key_len) {
+	if (map->keys_used + key_len + 1 > map->keys_capacity) {
+		int capacity = map->keys_capacity ? map->keys_capacity * 2 : 64;
+		while (capacity < map->keys_used + key_len + 1) {
+			capacity *= 2;
+		}
+		unsigned char *keys = realloc(map->keys, capacity);
+		if (!keys) {
+			printf("failed to allocate ordered hash keys");
+			return 0;
+		}
+		map->keys = keys;
+		map->keys_capacity = capacity;
+	}
+	int key_off = map->keys_used;
+	memcpy(map->keys + key_off, key, key_len);
+	map->keys[key_off + key_len] = '\0';
+	map->keys_used += key_len + 1;
+	return key_off;
+}
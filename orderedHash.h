@@ -0,0 +1,193 @@
+//---------------------------------------------------------
+// file:    orderedHash.h
+// author:  Jordan Hoffmann
+// brief:   Library for compact hash tables that remember insertion order
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+#include <string.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// number of entries and index slots in a new table
+#define OHASH_MIN_CAPACITY 8
+
+// index slot states. every other slot value is the position of an entry
+#define OHASH_EMPTY -1
+#define OHASH_REMOVED -2
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+typedef struct {
+	unsigned hash;			// full hash of the key
+	int key_len;			// number of bytes in the key, -1 once the entry is removed
+	int key_off;			// where the key starts in keys
+} _OHashEntry;
+
+typedef struct {
+	int count;				// number of keys stored
+	int used;				// entries handed out, including removed ones
+	int capacity;			// entries (and values) there is room for
+	int value_size;			// bytes in every value
+	_OHashEntry *entries;	// entries in insertion order
+	unsigned char *values;	// value of entry i is at values + i * value_size
+	unsigned char *keys;	// every key's bytes, each followed by '\0'
+	int keys_used;			// bytes of keys in use, including removed keys
+	int keys_capacity;		// bytes of keys allocated
+	int *index;				// open addressed slots holding entry positions (power of 2)
+	int index_size;			// number of slots in index
+	unsigned(*hash_func)(unsigned char *, int);	// function used to hash keys
+} OrderedHash;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		Allocates and initializes a new OrderedHash ptr
+* @details		an OrderedHash keeps its entries in one dense array in the order keys were first
+*				added, with values in a parallel array, and finds them through a small array
+*				of int positions. iterating only walks the dense array, so it is sequential
+*				and always gives the same order no matter how the table has grown.
+*				keys are copied into the table and values are stored inline.
+*
+* @param[in]	hash_func  - function that takes a key and its length and returns a "unique"
+*				unsigned int, or NULL for a default hashing function.
+* @param[in]	value_size - the size of every value stored. i.e sizeof(int)
+* @return		a pointer to a newly allocated and empty ordered hash table
+*/
+OrderedHash *ohash_create(unsigned(hash_func)(unsigned char *, int), int value_size);
+
+/**
+* @brief		frees an ordered hash table and all of its contents
+* @details		leave free_func NULL if the contents are not pointers or you wish to not free them.
+*
+* @param[in]	map		  - the table to free
+* @param[in]	free_func - function to call on every element in the table
+*/
+void ohash_free(OrderedHash *map, void(free_func)(void *));
+
+/**
+* @brief		adds a value, replacing the value already stored under the key if there is one
+* @details		a replaced value keeps the key's original place in the order.
+*
+* @param[in]	map		  - the table to add to
+* @param[in]	key		  - the key bytes (copied)
+* @param[in]	key_len	  - the number of bytes in key
+* @param[in]	val		  - pointer to the value to copy in (value_size bytes)
+* @param[in]	free_func - function to call on a value this replaces (or NULL)
+*/
+void ohash_put(OrderedHash *map, unsigned char *key, int key_len, void *val, void(free_func)(void *));
+
+/**
+* @brief		returns a pointer to the value stored under a key
+* @details		the pointer can be used to update the value in place. it is only valid until
+*				the next key is added or removed, since either may move the values.
+*
+* @param[in]	map		- the table to search
+* @param[in]	key		- the key bytes to search for
+* @param[in]	key_len	- the number of bytes in key
+* @return		the value, or NULL if the key isn't in the table
+*/
+void *ohash_get(OrderedHash *map, unsigned char *key, int key_len);
+
+/**
+* @brief		boolian function used to determine weather a key is in the table
+*
+* @param[in]	map		- the table to search
+* @param[in]	key		- the key bytes to search for
+* @param[in]	key_len	- the number of bytes in key
+* @return		1 if the key is found, 0 if it was not.
+*/
+bool ohash_exists(OrderedHash *map, unsigned char *key, int key_len);
+
+/**
+* @brief		removes the value stored under a key
+* @details		the entry is marked removed and skipped by iteration. once removed entries
+*				outnumber live ones the entries are packed together again, keeping their order.
+*
+* @param[in]	map		  - the table to remove from
+* @param[in]	key		  - the key bytes to search for
+* @param[in]	key_len	  - the number of bytes in key
+* @param[in]	free_func - function to call on the removed value (or NULL)
+* @return		1 if the key was removed, 0 if it wasn't in the table.
+*/
+bool ohash_rem(OrderedHash *map, unsigned char *key, int key_len, void(free_func)(void *));
+
+/**
+* @brief		packs the entries together and drops the space of removed keys
+* @details		order is kept. the arrays are shrunk to fit what is left.
+*
+* @param[in]	map - the table to compact
+*/
+void ohash_compact(OrderedHash *map);
+
+/**
+* @brief		adds an item to an ordered hash table under a string key
+*
+* @param[in]	type_t	   - the type of data being added. must match value_size
+* @param[in]	map		   - the table to add to
+* @param[in]	val		   - the actual data you would like to add
+* @param[in]	key_string - a unique lookup string for accessing your data later
+*/
+#define OHASH_ADD(type_t, map, val, key_string)												\
+	do {																					\
+		type_t _ohash_val = val;															\
+		ohash_put(map, key_string, (int)strlen((char *)(key_string)), &_ohash_val, NULL);	\
+	} while (0)
+
+/**
+* @brief		retrieves an item from an ordered hash table
+* @details		if the item isn't found, behavior is undefined. use ohash_exists() first.
+*
+* @param[in]	type_t	   - the type of data being accessed. i.e (int), (double *), etc.
+* @param[in]	map		   - the table to retrieve from
+* @param[in]	key_string - the lookup string you inserted your item with.
+*/
+#define OHASH_FIND(type_t, map, key_string) (*(type_t *)ohash_get(map, key_string, (int)strlen((char *)(key_string))))
+
+/**
+* @brief		returns a pointer to an item in an ordered hash table, or NULL if it isn't there
+*
+* @param[in]	type_t	   - the type of data being accessed. i.e (int), (double *), etc.
+* @param[in]	map		   - the table to retrieve from
+* @param[in]	key_string - the lookup string you inserted your item with.
+*/
+#define OHASH_FIND_PTR(type_t, map, key_string) ((type_t *)ohash_get(map, key_string, (int)strlen((char *)(key_string))))
+
+/**
+* @brief		run code with every key and value in insertion order
+* @details		keys are '\0' terminated copies, so string keys can be used as strings.
+*				don't add or remove keys inside run.
+* @note         the variable name _ii can not be used with this function
+*
+* @param[in]	type_t	 - the type of the values. i.e (int), (double *), etc.
+* @param[in]	key_item - your chosen variable name for the current key (unsigned char *)
+* @param[in]	val_item - your chosen variable name for the current value
+* @param[in]	map		 - the table you're itterating through
+* @param[in]	run		 - the code you would like to run. this can be multiple lines long
+*/
+#define OHASH_FOREACH(type_t, key_item, val_item, map, run)									\
+do {																						\
+	if (map) {																				\
+		for (int _ii = 0; _ii < (map)->used; _ii++) {										\
+			if ((map)->entries[_ii].key_len >= 0) {											\
+				unsigned char *key_item = (map)->keys + (map)->entries[_ii].key_off;		\
+				type_t val_item = *(type_t *)((map)->values + (size_t)_ii * (map)->value_size);	\
+				run;																		\
+			}																				\
+		}																					\
+	}																						\
+} while (0)
+
+/**
+* @brief		returns the number of keys in an ordered hash table
+*
+* @param[in]	map - the table you're querying the size of
+*/
+#define OHASH_SIZE(map) ((map) ? (map)->count : 0)
@@ -0,0 +1,185 @@
+//---------------------------------------------------------
+// file:    reclaimer.c
+// author:  Jordan Hoffmann
+// brief:   Library for freeing containers on a background thread, so
+//          the thread that drops them doesn't wait for every free_func
+//---------------------------------------------------------
+
+#include "reclaimer.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <threads.h>
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+// something waiting to be freed on the reclaimer's thread
+typedef struct {
+	void *ptr;							// memory to free
+	void(*reclaim_func)(void *, void(*)(void *));	// frees ptr (or NULL for free)
+	void(*free_func)(void *);			// passed on to reclaim_func
+} _ReclaimJob;
+
+struct Reclaimer {
+	mtx_t lock;							// guards everything below
+	cnd_t not_empty;					// signalled when a job is queued or the reclaimer stops
+	cnd_t not_full;						// signalled when a job leaves the queue
+	cnd_t done;							// signalled when a job has been freed
+	_ReclaimJob *jobs;					// ring buffer of queue_size jobs
+	int queue_size;						// number of slots in jobs
+	int head;							// oldest queued job
+	int count;							// number of queued jobs
+	long long retired;					// jobs ever queued
+	long long reclaimed;				// jobs ever freed. flush waits for this to catch up
+	bool stopping;						// set by reclaimer_free, the thread exits once the queue is empty
+	thrd_t thread;
+};
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static int _reclaimer_run(void *arg);
+static void _reclaimer_push(Reclaimer *reclaimer, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *));
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+Reclaimer *reclaimer_create(int queue_size) {
+	Reclaimer *reclaimer = malloc(sizeof(Reclaimer));
+	if (!reclaimer) {
+		printf("failed to allocate reclaimer");
+		return NULL;
+	}
+	reclaimer->queue_size = queue_size > 0 ? queue_size : RECLAIMER_QUEUE_SIZE;
+	reclaimer->jobs = malloc(reclaimer->queue_size * sizeof(_ReclaimJob));
+	if (!reclaimer->jobs) {
+		printf("failed to allocate reclaimer queue");
+		free(reclaimer);
+		return NULL;
+	}
+	reclaimer->head = 0;
+	reclaimer->count = 0;
+	reclaimer->retired = 0;
+	reclaimer->reclaimed = 0;
+	reclaimer->stopping = false;
+	mtx_init(&reclaimer->lock, mtx_plain);
+	cnd_init(&reclaimer->not_empty);
+	cnd_init(&reclaimer->not_full);
+	cnd_init(&reclaimer->done);
+	if (thrd_create(&reclaimer->thread, _reclaimer_run, reclaimer) != thrd_success) {
+		printf("failed to start reclaimer thread");
+		cnd_destroy(&reclaimer->done);
+		cnd_destroy(&reclaimer->not_full);
+		cnd_destroy(&reclaimer->not_empty);
+		mtx_destroy(&reclaimer->lock);
+		free(reclaimer->jobs);
+		free(reclaimer);
+		return NULL;
+	}
+	return reclaimer;
+}
+
+void reclaimer_free(Reclaimer *reclaimer) {
+	if (!reclaimer) {
+		return;
+	}
+	mtx_lock(&reclaimer->lock);
+	reclaimer->stopping = true;
+	cnd_signal(&reclaimer->not_empty);
+	mtx_unlock(&reclaimer->lock);
+	thrd_join(reclaimer->thread, NULL);
+
+	cnd_destroy(&reclaimer->done);
+	cnd_destroy(&reclaimer->not_full);
+	cnd_destroy(&reclaimer->not_empty);
+	mtx_destroy(&reclaimer->lock);
+	free(reclaimer->jobs);
+	free(reclaimer);
+}
+
+void reclaimer_retire(Reclaimer *reclaimer, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *)) {
+	mtx_lock(&reclaimer->lock);
+	// backpressure: the caller waits rather than letting the queue grow past its size
+	while (reclaimer->count == reclaimer->queue_size) {
+		cnd_wait(&reclaimer->not_full, &reclaimer->lock);
+	}
+	_reclaimer_push(reclaimer, ptr, reclaim_func, free_func);
+	mtx_unlock(&reclaimer->lock);
+}
+
+bool reclaimer_try_retire(Reclaimer *reclaimer, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *)) {
+	mtx_lock(&reclaimer->lock);
+	bool queued = reclaimer->count < reclaimer->queue_size;
+	if (queued) {
+		_reclaimer_push(reclaimer, ptr, reclaim_func, free_func);
+	}
+	mtx_unlock(&reclaimer->lock);
+	return queued;
+}
+
+void reclaimer_flush(Reclaimer *reclaimer) {
+	mtx_lock(&reclaimer->lock);
+	// jobs queued after this point aren't waited for, so a steady stream can't hold flush forever
+	long long target = reclaimer->retired;
+	while (reclaimer->reclaimed < target) {
+		cnd_wait(&reclaimer->done, &reclaimer->lock);
+	}
+	mtx_unlock(&reclaimer->lock);
+}
+
+int reclaimer_pending(Reclaimer *reclaimer) {
+	mtx_lock(&reclaimer->lock);
+	int pending = (int)(reclaimer->retired - reclaimer->reclaimed);
+	mtx_unlock(&reclaimer->lock);
+	return pending;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// the reclaimer's thread. frees jobs one at a time, without holding the lock while freeing
+static int _reclaimer_run(void *arg) {
+	Reclaimer *reclaimer = arg;
+	mtx_lock(&reclaimer->lock);
+	for (;;) {
+		while (reclaimer->count == 0 && !reclaimer->stopping) {
+			cnd_wait(&reclaimer->not_empty, &reclaimer->lock);
+		}
+		if (reclaimer->count == 0) {
+			// stopping, and everything queued has been freed
+			break;
+		}
+		_ReclaimJob job = reclaimer->jobs[reclaimer->head];
+		reclaimer->head = (reclaimer->head + 1) % reclaimer->queue_size;
+		reclaimer->count--;
+		cnd_signal(&reclaimer->not_full);
+		mtx_unlock(&reclaimer->lock);
+
+		if (job.reclaim_func) {
+			(*job.reclaim_func)(job.ptr, job.free_func);
+		}
+		else {
+			free(job.ptr);
+		}
+
+		mtx_lock(&reclaimer->lock);
+		reclaimer->reclaimed++;
+		cnd_broadcast(&reclaimer->done);
+	}
+	mtx_unlock(&reclaimer->lock);
+	return 0;
+}
+
+// queues a job. the lock is held and the queue has room
+static void _reclaimer_push(Reclaimer *reclaimer, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *)) {
+	_ReclaimJob *job = &reclaimer->jobs[(reclaimer->head + reclaimer->count) % reclaimer->queue_size];
+	job->ptr = ptr;
+	job->reclaim_func = reclaim_func;
+	job->free_func = free_func;
+	reclaimer->count++;
+	reclaimer->retired++;
+	cnd_signal(&reclaimer->not_empty);
+}
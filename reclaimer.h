@@ -0,0 +1,90 @@
+//---------------------------------------------------------
+// file:    reclaimer.h
+// author:  Jordan Hoffmann
+// brief:   Library for freeing containers on a background thread, so
+//          the thread that drops them doesn't wait for every free_func
+//---------------------------------------------------------
+
+#pragma once
+#include <stdbool.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// number of containers that can wait in a reclaimer's queue when 0 is passed to reclaimer_create
+#define RECLAIMER_QUEUE_SIZE 64
+
+//---------------------------------------------------------
+// Private Structures:
+//---------------------------------------------------------
+
+// the layout lives in reclaimer.c so that only it has to deal with threads
+typedef struct Reclaimer Reclaimer;
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+/**
+* @brief		Allocates and initializes a new Reclaimer ptr, starting its thread
+* @details		a Reclaimer frees whatever is handed to it on a thread of its own, in the
+*				order it was handed over. the queue is bounded: once queue_size containers
+*				are waiting, handing over another one blocks until the thread catches up,
+*				so a burst of frees can't pile up unbounded memory.
+*				hash_free_async, dna_free_async and link_free_async use one.
+*
+* @param[in]	queue_size - the number of containers that can wait at once, or 0 for RECLAIMER_QUEUE_SIZE
+* @return		a pointer to a newly allocated reclaimer, or NULL if its thread couldn't start
+*/
+Reclaimer *reclaimer_create(int queue_size);
+
+/**
+* @brief		frees everything still queued, then stops the thread and frees the reclaimer
+* @details		nothing may be handed to the reclaimer while (or after) it is freed.
+*
+* @param[in]	reclaimer - the reclaimer to shut down
+*/
+void reclaimer_free(Reclaimer *reclaimer);
+
+/**
+* @brief		hands memory to the reclaimer's thread to be freed
+* @details		returns right away unless the queue is full, in which case it waits for a free spot.
+*				reclaim_func(ptr, free_func) is called on the reclaimer's thread, or free(ptr)
+*				if reclaim_func is NULL. ptr must not be used by anyone after this.
+*
+* @param[in]	reclaimer	 - the reclaimer to hand ptr to
+* @param[in]	ptr			 - the memory to free
+* @param[in]	reclaim_func - function that frees ptr (or NULL)
+* @param[in]	free_func	 - passed on to reclaim_func, i.e for freeing the elements of a container
+*/
+void reclaimer_retire(Reclaimer *reclaimer, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *));
+
+/**
+* @brief		boolian function that hands memory to the reclaimer only if the queue has room
+* @details		like reclaimer_retire, but never waits. when it returns 0 the caller still owns
+*				ptr and can free it itself or try again later.
+*
+* @param[in]	reclaimer	 - the reclaimer to hand ptr to
+* @param[in]	ptr			 - the memory to free
+* @param[in]	reclaim_func - function that frees ptr (or NULL)
+* @param[in]	free_func	 - passed on to reclaim_func
+* @return		1 if ptr was queued, 0 if the queue was full
+*/
+bool reclaimer_try_retire(Reclaimer *reclaimer, void *ptr, void(reclaim_func)(void *, void(*)(void *)), void(free_func)(void *));
+
+/**
+* @brief		waits until everything handed to the reclaimer before this call has been freed
+* @details		handy before checking memory use, or before freeing whatever a free_func needs.
+*
+* @param[in]	reclaimer - the reclaimer to wait for
+*/
+void reclaimer_flush(Reclaimer *reclaimer);
+
+/**
+* @brief		returns the number of things handed to the reclaimer that aren't freed yet
+*
+* @param[in]	reclaimer - the reclaimer you're querying
+* @return		the number of queued (or currently being freed) allocations
+*/
+int reclaimer_pending(Reclaimer *reclaimer);
@@ -0,0 +1,154 @@
+//---------------------------------------------------------
+// file:    concurrentHash.c
+// author:  Jordan Hoffmann
+// brief:   test for ConcurrentHash: writers put, get and remove their own
+//          keys while readers check keys that never change, and the
+//          table grows several times underneath all of them
+//---------------------------------------------------------
+
+#include "../data_structures.h"
+#include <stdio.h>
+#include <stdatomic.h>
+#include <threads.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+#define WRITERS 4
+#define READERS 4
+
+// keys every writer adds, enough for the table to double several times while they run
+#define WRITER_KEYS 20000
+
+// keys added before any thread starts, which every reader checks over and over
+#define BASE_KEYS 1000
+
+//---------------------------------------------------------
+// Private Variables:
+//---------------------------------------------------------
+
+static ConcurrentHash *map;
+static atomic_int failures;
+static atomic_int writers_done;
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static int _write(void *arg);
+static int _read(void *arg);
+static void _fail(const char *what, const char *key);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+int main(void) {
+	map = chash_create(NULL, sizeof(int));
+	if (!map) {
+		printf("couldn't create the table\n");
+		return 1;
+	}
+	atomic_init(&failures, 0);
+	atomic_init(&writers_done, 0);
+	char key[32];
+	for (int i = 0; i < BASE_KEYS; i++) {
+		sprintf(key, "base%d", i);
+		CHASH_ADD(int, map, i, (unsigned char *)key);
+	}
+
+	thrd_t threads[WRITERS + READERS];
+	int ids[WRITERS];
+	for (int i = 0; i < WRITERS; i++) {
+		ids[i] = i;
+		thrd_create(&threads[i], _write, &ids[i]);
+	}
+	for (int i = 0; i < READERS; i++) {
+		thrd_create(&threads[WRITERS + i], _read, NULL);
+	}
+	for (int i = 0; i < WRITERS + READERS; i++) {
+		thrd_join(threads[i], NULL);
+	}
+
+	// writers removed every even key of their own
+	if (chash_count(map) != BASE_KEYS + WRITERS * WRITER_KEYS / 2) {
+		printf("count is %d, expected %d\n", chash_count(map), BASE_KEYS + WRITERS * WRITER_KEYS / 2);
+		atomic_fetch_add(&failures, 1);
+	}
+	for (int id = 0; id < WRITERS; id++) {
+		for (int i = 0; i < WRITER_KEYS; i++) {
+			sprintf(key, "w%d-%d", id, i);
+			int val = -1;
+			bool found = CHASH_FIND(map, (unsigned char *)key, val);
+			if (found != (i % 2 == 1) || (found && val != i)) {
+				_fail("wrong at the end", key);
+			}
+		}
+	}
+	chash_free(map, NULL);
+
+	if (atomic_load(&failures)) {
+		printf("%d failed checks\n", atomic_load(&failures));
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// puts every key of one writer, reads each back, then replaces the odd ones and removes the even ones
+static int _write(void *arg) {
+	int id = *(int *)arg;
+	char key[32];
+	for (int i = 0; i < WRITER_KEYS; i++) {
+		sprintf(key, "w%d-%d", id, i);
+		int val = -i;
+		CHASH_ADD(int, map, val, (unsigned char *)key);
+		if (!CHASH_FIND(map, (unsigned char *)key, val) || val != -i) {
+			_fail("missing right after its put", key);
+		}
+	}
+	for (int i = 0; i < WRITER_KEYS; i++) {
+		sprintf(key, "w%d-%d", id, i);
+		if (i % 2) {
+			CHASH_ADD(int, map, i, (unsigned char *)key);
+		}
+		else if (!chash_rem(map, (unsigned char *)key, (int)strlen(key), NULL)) {
+			_fail("couldn't be removed", key);
+		}
+	}
+	atomic_fetch_add(&writers_done, 1);
+	return 0;
+}
+
+// checks the base keys until every writer is done, and that writers' keys never have a torn value
+static int _read(void *arg) {
+	(void)arg;
+	char key[32];
+	int round = 0;
+	while (atomic_load(&writers_done) < WRITERS || round == 0) {
+		for (int i = 0; i < BASE_KEYS; i++) {
+			sprintf(key, "base%d", i);
+			int val = -1;
+			if (!CHASH_FIND(map, (unsigned char *)key, val) || val != i) {
+				_fail("lost while writers ran", key);
+			}
+			sprintf(key, "w%d-%d", i % WRITERS, i * 7 % WRITER_KEYS);
+			if (CHASH_FIND(map, (unsigned char *)key, val) && val != i * 7 % WRITER_KEYS && val != -(i * 7 % WRITER_KEYS)) {
+				_fail("had a value it was never given", key);
+			}
+		}
+		round++;
+	}
+	return 0;
+}
+
+// reports a failed check, only printing the first few
+static void _fail(const char *what, const char *key) {
+	if (atomic_fetch_add(&failures, 1) < 10) {
+		printf("%s %s\n", key, what);
+	}
+}
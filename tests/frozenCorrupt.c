@@ -0,0 +1,194 @@
+//---------------------------------------------------------
+// file:    frozenCorrupt.c
+// author:  Jordan Hoffmann
+// brief:   regression test for hash_map: snapshots with a truncated
+//          or corrupted header have to be rejected when opened
+//---------------------------------------------------------
+
+#include "../data_structures.h"
+#include <stdio.h>
+#include <stdint.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// keys in the snapshot that gets corrupted
+#define KEY_COUNT 1000
+
+// written next to the test executable and removed at the end
+#define SNAPSHOT_PATH "frozen_corrupt.bin"
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static unsigned char *_read_file(const char *path, long *size);
+static bool _write_file(const char *path, unsigned char *bytes, long size);
+static int _check_rejected(const char *name, unsigned char *snapshot, long size, long keep,
+						   void(corrupt)(_FrozenHeader *));
+static void _wrap_seeds(_FrozenHeader *header);
+static void _wrap_remap(_FrozenHeader *header);
+static void _wrap_values(_FrozenHeader *header);
+static void _keys_past_end(_FrozenHeader *header);
+static void _total_past_file(_FrozenHeader *header);
+static void _no_buckets(_FrozenHeader *header);
+static void _seeds_in_header(_FrozenHeader *header);
+static void _misaligned_slots(_FrozenHeader *header);
+static void _short_stride(_FrozenHeader *header);
+static void _bad_magic(_FrozenHeader *header);
+static void _unchanged(_FrozenHeader *header);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+int main(void) {
+	HashTable *table = hash_create_ex(NULL, HASH_OWN_KEYS);
+	char key[32];
+	for (int i = 0; i < KEY_COUNT; i++) {
+		sprintf(key, "k%d", i);
+		HASH_ADD(int, table, i, (unsigned char *)key);
+	}
+	if (!hash_save(table, SNAPSHOT_PATH, sizeof(int))) {
+		printf("couldn't save the snapshot\n");
+		return 1;
+	}
+	hash_free(table, NULL);
+	long size = 0;
+	unsigned char *snapshot = _read_file(SNAPSHOT_PATH, &size);
+	if (!snapshot) {
+		return 1;
+	}
+
+	// the untouched file has to open, or the rest proves nothing
+	FrozenHash *frozen = _write_file(SNAPSHOT_PATH, snapshot, size) ? hash_map(SNAPSHOT_PATH) : NULL;
+	int failures = frozen && frozen_exists(frozen, (unsigned char *)"k0") ? 0 : 1;
+	if (failures) {
+		printf("the unchanged snapshot didn't open\n");
+	}
+	frozen_free(frozen);
+
+	failures += _check_rejected("seeds_off that wraps", snapshot, size, size, _wrap_seeds);
+	failures += _check_rejected("remap_off that wraps", snapshot, size, size, _wrap_remap);
+	failures += _check_rejected("values_off that wraps", snapshot, size, size, _wrap_values);
+	failures += _check_rejected("keys_off past the end", snapshot, size, size, _keys_past_end);
+	failures += _check_rejected("total_size past the file", snapshot, size, size, _total_past_file);
+	failures += _check_rejected("no buckets", snapshot, size, size, _no_buckets);
+	failures += _check_rejected("seeds inside the header", snapshot, size, size, _seeds_in_header);
+	failures += _check_rejected("misaligned slots", snapshot, size, size, _misaligned_slots);
+	failures += _check_rejected("value_stride under value_size", snapshot, size, size, _short_stride);
+	failures += _check_rejected("bad magic", snapshot, size, size, _bad_magic);
+	failures += _check_rejected("truncated file", snapshot, size, size / 2, _unchanged);
+	failures += _check_rejected("truncated header", snapshot, size, sizeof(_FrozenHeader) - 1, _unchanged);
+	failures += _check_rejected("empty file", snapshot, size, 0, _unchanged);
+
+	free(snapshot);
+	remove(SNAPSHOT_PATH);
+	if (failures) {
+		printf("%d failed checks\n", failures);
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+static unsigned char *_read_file(const char *path, long *size) {
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		printf("couldn't open %s\n", path);
+		return NULL;
+	}
+	fseek(file, 0, SEEK_END);
+	*size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	unsigned char *bytes = malloc(*size);
+	if (!bytes || fread(bytes, 1, *size, file) != (size_t)*size) {
+		printf("couldn't read %s\n", path);
+		free(bytes);
+		bytes = NULL;
+	}
+	fclose(file);
+	return bytes;
+}
+
+static bool _write_file(const char *path, unsigned char *bytes, long size) {
+	FILE *file = fopen(path, "wb");
+	if (!file) {
+		printf("couldn't write %s\n", path);
+		return false;
+	}
+	bool written = fwrite(bytes, 1, size, file) == (size_t)size;
+	fclose(file);
+	return written;
+}
+
+// writes the first keep bytes of snapshot with corrupt applied to its header, and checks
+// hash_map won't open it. returns the number of failed checks
+static int _check_rejected(const char *name, unsigned char *snapshot, long size, long keep,
+						   void(corrupt)(_FrozenHeader *)) {
+	unsigned char *bytes = malloc(size);
+	if (!bytes) {
+		printf("failed to allocate a copy of the snapshot\n");
+		return 1;
+	}
+	memcpy(bytes, snapshot, size);
+	corrupt((_FrozenHeader *)bytes);
+	FrozenHash *frozen = _write_file(SNAPSHOT_PATH, bytes, keep) ? hash_map(SNAPSHOT_PATH) : NULL;
+	free(bytes);
+	if (frozen) {
+		printf("hash_map opened a snapshot with %s\n", name);
+		frozen_free(frozen);
+		return 1;
+	}
+	return 0;
+}
+
+// with bucket_count seeds, the end of the section wraps around to just past the start
+static void _wrap_seeds(_FrozenHeader *header) {
+	header->bucket_count = 16384;
+	header->seeds_off = UINT64_MAX - 65535;
+}
+
+static void _wrap_remap(_FrozenHeader *header) {
+	header->remap_off = UINT64_MAX - 7;
+}
+
+static void _wrap_values(_FrozenHeader *header) {
+	header->values_off = UINT64_MAX - 15;
+}
+
+static void _keys_past_end(_FrozenHeader *header) {
+	header->keys_off = header->total_size + 16;
+}
+
+static void _total_past_file(_FrozenHeader *header) {
+	header->total_size += 4096;
+}
+
+static void _no_buckets(_FrozenHeader *header) {
+	header->bucket_count = 0;
+}
+
+static void _seeds_in_header(_FrozenHeader *header) {
+	header->seeds_off = 0;
+}
+
+static void _misaligned_slots(_FrozenHeader *header) {
+	header->slots_off += 4;
+}
+
+static void _short_stride(_FrozenHeader *header) {
+	header->value_size = header->value_stride + 1;
+}
+
+static void _bad_magic(_FrozenHeader *header) {
+	header->magic ^= 1;
+}
+
+static void _unchanged(_FrozenHeader *header) {
+	(void)header;
+}
@@ -0,0 +1,109 @@
+//---------------------------------------------------------
+// file:    frozenRoundTrip.c
+// author:  Jordan Hoffmann
+// brief:   test for FrozenHash: every key of a table has to be found
+//          with its value after hash_freeze, and after hash_save and
+//          hash_map, and keys that were never added must not be
+//---------------------------------------------------------
+
+#include "../data_structures.h"
+#include <stdio.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// enough keys for many buckets, including keys long enough for the key arena
+#define KEY_COUNT 20000
+
+// written next to the test executable and removed at the end
+#define SNAPSHOT_PATH "frozen_round_trip.bin"
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static void _key(char *key, int i);
+static int _check_frozen(const char *name, FrozenHash *frozen);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+int main(void) {
+	HashTable *table = hash_create_ex(NULL, HASH_OWN_KEYS);
+	char key[64];
+	for (int i = 0; i < KEY_COUNT; i++) {
+		_key(key, i);
+		HASH_ADD(double, table, i * 0.5, (unsigned char *)key);
+	}
+
+	int failures = _check_frozen("hash_freeze", hash_freeze(table, sizeof(double)));
+	if (!hash_save(table, SNAPSHOT_PATH, sizeof(double))) {
+		printf("couldn't save the snapshot\n");
+		failures++;
+	}
+	hash_free(table, NULL);
+	// the file has to stand on its own once the table is gone
+	FrozenHash *mapped = hash_map(SNAPSHOT_PATH);
+	if (mapped && !mapped->mapped) {
+		printf("hash_map didn't map the file\n");
+		failures++;
+	}
+	failures += _check_frozen("hash_map", mapped);
+	remove(SNAPSHOT_PATH);
+
+	// an empty table still round trips
+	table = hash_create_ex(NULL, HASH_OWN_KEYS);
+	FrozenHash *empty = hash_freeze(table, sizeof(double));
+	if (!empty || FROZEN_SIZE(empty) != 0 || frozen_exists(empty, (unsigned char *)"k0")) {
+		printf("an empty table didn't freeze empty\n");
+		failures++;
+	}
+	frozen_free(empty);
+	hash_free(table, NULL);
+
+	if (failures) {
+		printf("%d failed checks\n", failures);
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// every third key is longer than HASH_INLINE_KEY_SIZE
+static void _key(char *key, int i) {
+	sprintf(key, i % 3 ? "k%d" : "a_long_key_for_the_arena_%d", i);
+}
+
+// checks every key and value of the table built in main, and a miss for each, then frees frozen
+static int _check_frozen(const char *name, FrozenHash *frozen) {
+	if (!frozen) {
+		printf("%s returned NULL\n", name);
+		return 1;
+	}
+	int failures = 0;
+	if (FROZEN_SIZE(frozen) != KEY_COUNT) {
+		printf("%s holds %d keys, expected %d\n", name, FROZEN_SIZE(frozen), KEY_COUNT);
+		failures++;
+	}
+	char key[64];
+	for (int i = 0; i < KEY_COUNT && failures < 10; i++) {
+		_key(key, i);
+		if (!frozen_exists(frozen, (unsigned char *)key) || FROZEN_FIND(double, frozen, (unsigned char *)key) != i * 0.5) {
+			printf("%s lost %s\n", name, key);
+			failures++;
+		}
+		// same length and nearly the same bytes, so only the key compare can turn it away
+		key[0] = key[0] == 'k' ? 'j' : 'b';
+		if (frozen_exists(frozen, (unsigned char *)key)) {
+			printf("%s found %s, which was never added\n", name, key);
+			failures++;
+		}
+	}
+	frozen_free(frozen);
+	return failures;
+}
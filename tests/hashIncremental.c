@@ -0,0 +1,70 @@
+//---------------------------------------------------------
+// file:    hashIncremental.c
+// author:  Jordan Hoffmann
+// brief:   regression test for HASH_INCREMENTAL tables: every key has
+//          to be findable right after the add that starts a grow
+//---------------------------------------------------------
+
+#include "../data_structures.h"
+#include <stdio.h>
+
+//---------------------------------------------------------
+// Private Consts:
+//---------------------------------------------------------
+
+// enough adds to go through several grows from the smallest table
+#define KEY_COUNT 2000
+
+// values added under every key of the HASH_MULTI table
+#define VALS_PER_KEY 3
+
+//---------------------------------------------------------
+// Private Function Declarations:
+//---------------------------------------------------------
+static int _check_adds(int flags, int vals_per_key);
+
+//---------------------------------------------------------
+// Public Functions:
+//---------------------------------------------------------
+
+int main(void) {
+	int failures = _check_adds(HASH_INCREMENTAL | HASH_OWN_KEYS, 1);
+	failures += _check_adds(HASH_INCREMENTAL | HASH_OWN_KEYS | HASH_MULTI, VALS_PER_KEY);
+	if (failures) {
+		printf("%d failed checks\n", failures);
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}
+
+//---------------------------------------------------------
+// Private Functions:
+//---------------------------------------------------------
+
+// adds KEY_COUNT keys (vals_per_key times each), checking every key added so far after each add
+static int _check_adds(int flags, int vals_per_key) {
+	HashTable *table = hash_create_ex(NULL, flags);
+	char key[32];
+	int failures = 0;
+	for (int i = 0; i < KEY_COUNT; i++) {
+		sprintf(key, "k%d", i);
+		for (int v = 0; v < vals_per_key; v++) {
+			HASH_ADD(int, table, i, (unsigned char *)key);
+		}
+		for (int j = 0; j <= i; j++) {
+			sprintf(key, "k%d", j);
+			if (!hash_exists(table, (unsigned char *)key)) {
+				printf("k%d is missing after adding k%d (flags %d)\n", j, i, flags);
+				failures++;
+			}
+			else if (vals_per_key > 1 && hash_count_key(table, (unsigned char *)key) != vals_per_key) {
+				printf("k%d has %d values after adding k%d (flags %d)\n", j,
+					hash_count_key(table, (unsigned char *)key), i, flags);
+				failures++;
+			}
+		}
+	}
+	hash_free(table, NULL);
+	return failures;
+}